@@ -1,57 +1,143 @@
 #include "application.h"
+#include "logger.h"
+#include "resources.h"
 #include "utils.h"
 
 #include <GLFW/glfw3.h>
 #include <glfw3webgpu.h>
 #include <imgui.h>
-#include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_wgpu.h>
 
 #include <array>
 #include <exception>
-#include <iostream>
 #include <cmath>
 #include <vector>
 #include <numeric>
 #include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include <utility>
 
 namespace {
-void setWGPUCallbacks(WGPUDevice device, WGPUQueue queue) {
+// Dear ImGui updates hover and active states one frame late, so a few extra
+// frames are drawn after the last input event to let the overlay settle.
+constexpr int guiSettleFrames = 3;
+
+// Category of the GPU objects owned directly by the application
+constexpr const char *resourceCategory = "Application";
+
+struct BenchmarkView {
+    const char *name;
+    double x;
+    double y;
+    double scale;
+};
+// Views along the boundary, where neighbouring escape times differ most
+constexpr std::array<BenchmarkView, 4> benchmarkViews = {{
+    { "full set", -0.5, 0.0, 1.5 },
+    { "seahorse valley", -0.7453, 0.1127, 200.0 },
+    { "elephant valley", 0.2850, 0.0110, 100.0 },
+    { "spiral", -0.1011, 0.9563, 500.0 },
+}};
+
+// Value at the given fraction of the sorted samples
+double percentile(std::vector<double> values, double fraction)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// Same mapping as the imgui_impl_glfw backend, for keys in the US layout
+ImGuiKey glfwKeyToImGuiKey(int key)
+{
+    // Both libraries number these ranges contiguously
+    if (key >= GLFW_KEY_0 && key <= GLFW_KEY_9) {
+        return static_cast<ImGuiKey>(ImGuiKey_0 + (key - GLFW_KEY_0));
+    }
+    if (key >= GLFW_KEY_A && key <= GLFW_KEY_Z) {
+        return static_cast<ImGuiKey>(ImGuiKey_A + (key - GLFW_KEY_A));
+    }
+    if (key >= GLFW_KEY_F1 && key <= GLFW_KEY_F12) {
+        return static_cast<ImGuiKey>(ImGuiKey_F1 + (key - GLFW_KEY_F1));
+    }
+    if (key >= GLFW_KEY_KP_0 && key <= GLFW_KEY_KP_9) {
+        return static_cast<ImGuiKey>(ImGuiKey_Keypad0 + (key - GLFW_KEY_KP_0));
+    }
+    switch (key) {
+    case GLFW_KEY_TAB: return ImGuiKey_Tab;
+    case GLFW_KEY_LEFT: return ImGuiKey_LeftArrow;
+    case GLFW_KEY_RIGHT: return ImGuiKey_RightArrow;
+    case GLFW_KEY_UP: return ImGuiKey_UpArrow;
+    case GLFW_KEY_DOWN: return ImGuiKey_DownArrow;
+    case GLFW_KEY_PAGE_UP: return ImGuiKey_PageUp;
+    case GLFW_KEY_PAGE_DOWN: return ImGuiKey_PageDown;
+    case GLFW_KEY_HOME: return ImGuiKey_Home;
+    case GLFW_KEY_END: return ImGuiKey_End;
+    case GLFW_KEY_INSERT: return ImGuiKey_Insert;
+    case GLFW_KEY_DELETE: return ImGuiKey_Delete;
+    case GLFW_KEY_BACKSPACE: return ImGuiKey_Backspace;
+    case GLFW_KEY_SPACE: return ImGuiKey_Space;
+    case GLFW_KEY_ENTER: return ImGuiKey_Enter;
+    case GLFW_KEY_ESCAPE: return ImGuiKey_Escape;
+    case GLFW_KEY_APOSTROPHE: return ImGuiKey_Apostrophe;
+    case GLFW_KEY_COMMA: return ImGuiKey_Comma;
+    case GLFW_KEY_MINUS: return ImGuiKey_Minus;
+    case GLFW_KEY_PERIOD: return ImGuiKey_Period;
+    case GLFW_KEY_SLASH: return ImGuiKey_Slash;
+    case GLFW_KEY_SEMICOLON: return ImGuiKey_Semicolon;
+    case GLFW_KEY_EQUAL: return ImGuiKey_Equal;
+    case GLFW_KEY_LEFT_BRACKET: return ImGuiKey_LeftBracket;
+    case GLFW_KEY_BACKSLASH: return ImGuiKey_Backslash;
+    case GLFW_KEY_RIGHT_BRACKET: return ImGuiKey_RightBracket;
+    case GLFW_KEY_GRAVE_ACCENT: return ImGuiKey_GraveAccent;
+    case GLFW_KEY_CAPS_LOCK: return ImGuiKey_CapsLock;
+    case GLFW_KEY_SCROLL_LOCK: return ImGuiKey_ScrollLock;
+    case GLFW_KEY_NUM_LOCK: return ImGuiKey_NumLock;
+    case GLFW_KEY_PRINT_SCREEN: return ImGuiKey_PrintScreen;
+    case GLFW_KEY_PAUSE: return ImGuiKey_Pause;
+    case GLFW_KEY_KP_DECIMAL: return ImGuiKey_KeypadDecimal;
+    case GLFW_KEY_KP_DIVIDE: return ImGuiKey_KeypadDivide;
+    case GLFW_KEY_KP_MULTIPLY: return ImGuiKey_KeypadMultiply;
+    case GLFW_KEY_KP_SUBTRACT: return ImGuiKey_KeypadSubtract;
+    case GLFW_KEY_KP_ADD: return ImGuiKey_KeypadAdd;
+    case GLFW_KEY_KP_ENTER: return ImGuiKey_KeypadEnter;
+    case GLFW_KEY_KP_EQUAL: return ImGuiKey_KeypadEqual;
+    case GLFW_KEY_LEFT_SHIFT: return ImGuiKey_LeftShift;
+    case GLFW_KEY_LEFT_CONTROL: return ImGuiKey_LeftCtrl;
+    case GLFW_KEY_LEFT_ALT: return ImGuiKey_LeftAlt;
+    case GLFW_KEY_LEFT_SUPER: return ImGuiKey_LeftSuper;
+    case GLFW_KEY_RIGHT_SHIFT: return ImGuiKey_RightShift;
+    case GLFW_KEY_RIGHT_CONTROL: return ImGuiKey_RightCtrl;
+    case GLFW_KEY_RIGHT_ALT: return ImGuiKey_RightAlt;
+    case GLFW_KEY_RIGHT_SUPER: return ImGuiKey_RightSuper;
+    case GLFW_KEY_MENU: return ImGuiKey_Menu;
+    default: return ImGuiKey_None;
+    }
+}
+
+// Errors are only logged and counted here; throwing across the C callback
+// is undefined, so the render loop checks the count after ticking the device
+void setWGPUCallbacks(WGPUDevice device, std::atomic<uint32_t> *errorCount) {
     auto onDeviceError = [](WGPUErrorType type, char const *message,
-                            void * /* pUserData */) {
-        std::cout << "Uncaptured device error: type " << type;
-        if (message)
-            std::cout << " (" << message << ")";
-        std::cout << std::endl;
-        throw std::runtime_error(message);
+                            void *pUserData) {
+        Log::error() << "Uncaptured device error: type " << type
+                     << " (" << (message ? message : "no message") << ")";
+        reinterpret_cast<std::atomic<uint32_t> *>(pUserData)->fetch_add(1, std::memory_order_relaxed);
     };
     auto onDeviceLost = [](WGPUDeviceLostReason reason, char const* message, void*){
-        std::cout << "Device lost error: reason" << reason;
-        if (message)
-            std::cout << " (" << message << ")";
-        std::cout << std::endl;
+        Log::error() << "Device lost error: reason " << reason
+                     << " (" << (message ? message : "no message") << ")";
     };
     wgpuDeviceSetDeviceLostCallback(device, onDeviceLost, nullptr);
-    wgpuDeviceSetUncapturedErrorCallback(device, onDeviceError,
-                                         nullptr /* pUserData */);
-
-    auto onQueueWorkDone = [](WGPUQueueWorkDoneStatus status,
-                              void * /* pUserData */) {
-        std::cout << "Queued work finished with status: " << status << std::endl;
-    };
-    wgpuQueueOnSubmittedWorkDone(queue, onQueueWorkDone,
-                                 nullptr /* pUserData */);
-}
-
-void onWindowResize(GLFWwindow *window, int /* width */, int /* height */) {
-    // We know that even though from GLFW's point of view this is
-    // "just a pointer", in our case it is always a pointer to an
-    // instance of the class `Application`
-    auto that = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
-
-    // Call the actual class-member callback
-    if (that != nullptr)
-        that->onResize();
+    wgpuDeviceSetUncapturedErrorCallback(device, onDeviceError, errorCount);
 }
 
 void setGLFWcallbacks(GLFWwindow *window) {
@@ -84,7 +170,7 @@ void setGLFWcallbacks(GLFWwindow *window) {
 
     glfwSetScrollCallback(window, onScroll);
 
-    auto onWindowResize = [](GLFWwindow *window, int width, int height) {
+    auto onWindowResize = [](GLFWwindow *window, int /* width */, int /* height */) {
         auto that =
             reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
         if (that != nullptr)
@@ -92,20 +178,90 @@ void setGLFWcallbacks(GLFWwindow *window) {
     };
 
     glfwSetFramebufferSizeCallback(window, onWindowResize);
+
+    auto onKey = [](GLFWwindow *window, int key, int /* scancode */,
+                    int action, int mods) {
+        auto that = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
+        if (that != nullptr)
+            that->onKey(key, action, mods);
+    };
+    glfwSetKeyCallback(window, onKey);
+
+    auto onChar = [](GLFWwindow *window, unsigned int codepoint) {
+        auto that = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
+        if (that != nullptr)
+            that->onChar(codepoint);
+    };
+    glfwSetCharCallback(window, onChar);
+
+    auto onFocus = [](GLFWwindow *window, int focused) {
+        auto that = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
+        if (that != nullptr)
+            that->onFocus(focused == GLFW_TRUE);
+    };
+    glfwSetWindowFocusCallback(window, onFocus);
+
+    auto onCursorEnter = [](GLFWwindow *window, int entered) {
+        auto that = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
+        if (that != nullptr)
+            that->onCursorEnter(entered == GLFW_TRUE);
+    };
+    glfwSetCursorEnterCallback(window, onCursorEnter);
+
+    auto onRefresh = [](GLFWwindow *window) {
+        auto that = reinterpret_cast<Application *>(glfwGetWindowUserPointer(window));
+        if (that != nullptr)
+            that->onRefresh();
+    };
+    glfwSetWindowRefreshCallback(window, onRefresh);
 }
 
 } // namespace
 
-Application::Application()
+InputTrace::LaunchSettings Application::Settings::launchSettings() const
 {
+    InputTrace::LaunchSettings launch;
+    launch.presentMode = static_cast<uint32_t>(presentMode);
+    launch.featureTier = static_cast<uint8_t>(maxFeatureTier);
+    launch.maxFramesInFlight = static_cast<uint8_t>(maxFramesInFlight);
+    launch.continuous = continuous;
+    launch.renderThread = renderThread;
+    return launch;
+}
+
+void Application::Settings::applyLaunchSettings(const InputTrace::LaunchSettings& launch)
+{
+    presentMode = static_cast<WGPUPresentMode>(launch.presentMode);
+    maxFeatureTier = static_cast<DeviceCapabilities::Tier>(launch.featureTier);
+    maxFramesInFlight = launch.maxFramesInFlight;
+    continuous = launch.continuous;
+    renderThread = launch.renderThread;
+}
+
+Application::Application(const Settings& settings)
+    : m_settings(settings)
+{
+    Resources::setOverrideDirectory(m_settings.resourceDirectory);
+
     // Create Window
     if(!glfwInit()) {
-        std::cerr << "Failed to initialise GLFW!" << std::endl;
+        Log::error() << "Failed to initialise GLFW!";
         throw std::runtime_error("Failed to initialise GLFW!");
     }
 
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+    const bool replaying = !m_settings.replayPath.empty();
+    if (replaying && !m_settings.recordPath.empty()) {
+        throw std::runtime_error("Cannot record while replaying an input trace!");
+    }
+    // A replay only takes input from its trace
+    glfwWindowHint(GLFW_VISIBLE, replaying ? GLFW_FALSE : GLFW_TRUE);
+    if (replaying || !m_settings.benchmark.empty()) {
+        // Their frame times should not include waiting for vsync, which hidden
+        // windows may also be throttled to. Unsupported modes fall back to fifo.
+        m_settings.presentMode = WGPUPresentMode_Immediate;
+    }
     m_window = glfwCreateWindow(m_uniforms.windowWidth, m_uniforms.windowHeight, "WebGPU Test", nullptr, nullptr);
 
     if(!m_window) {
@@ -113,7 +269,9 @@ Application::Application()
         throw std::runtime_error("Failed to open window!");
     }
     glfwSetWindowUserPointer(m_window, this);
-    setGLFWcallbacks(m_window);
+    if (!replaying) {
+        setGLFWcallbacks(m_window);
+    }
 
     float xscale, yscale;
     GLFWmonitor* primary = glfwGetPrimaryMonitor();
@@ -123,14 +281,14 @@ Application::Application()
     // Create WGPU instance
     WGPUInstanceDescriptor desc{};
     desc.nextInChain = nullptr;
-    m_instance = wgpuCreateInstance(&desc);
+    m_instance = GpuInstance(wgpuCreateInstance(&desc), resourceCategory);
 
     if(!m_instance){
         throw std::runtime_error("Failed to initialise WebGPU!");
     }
 
     // Get surface
-    m_surface = glfwGetWGPUSurface(m_instance, m_window);
+    m_surface = GpuSurface(glfwGetWGPUSurface(m_instance, m_window), resourceCategory);
     if(!m_surface) {
         throw std::runtime_error("Failed to initialise surface!");
     }
@@ -140,47 +298,46 @@ Application::Application()
     adapterOpts.nextInChain = nullptr;
     adapterOpts.compatibleSurface = m_surface;
 
-    m_adapter = Utils::requestAdapter(m_instance, &adapterOpts);
+    m_adapter = GpuAdapter(Utils::requestAdapter(m_instance, &adapterOpts), resourceCategory);
 
-    std::vector<WGPUFeatureName> featuresList;
-    featuresList.resize(wgpuAdapterEnumerateFeatures(m_adapter, nullptr));
-    wgpuAdapterEnumerateFeatures(m_adapter, featuresList.data());
-
-    // Setup limits
-    WGPUSupportedLimits supportedLimits {};
-    wgpuAdapterGetLimits(m_adapter, &supportedLimits);
-
-    WGPURequiredLimits requiredLimits {};
-    requiredLimits.limits.maxVertexAttributes = 2;
-    requiredLimits.limits.maxVertexBuffers = 1;
-    requiredLimits.limits.maxBufferSize = 2 * 4 * sizeof(float);
-    requiredLimits.limits.maxVertexBufferArrayStride = 5 * sizeof(float);
-    requiredLimits.limits.minStorageBufferOffsetAlignment = supportedLimits.limits.minStorageBufferOffsetAlignment;
-    requiredLimits.limits.minUniformBufferOffsetAlignment = supportedLimits.limits.minUniformBufferOffsetAlignment;
-    requiredLimits.limits.maxBindGroups = 2;
-    requiredLimits.limits.maxUniformBuffersPerShaderStage = 1;
-    requiredLimits.limits.maxUniformBufferBindingSize = 16 * sizeof(float);
+    // Ask for the best limits and optional features the adapter offers
+    m_capabilities = DeviceCapabilities::fromAdapter(m_adapter, m_settings.maxFeatureTier);
 
     // Get logical device and queue
     WGPUDeviceDescriptor deviceDesc{};
     deviceDesc.nextInChain = nullptr;
     deviceDesc.label = "Device";
-    deviceDesc.requiredFeatureCount = 0;
-    deviceDesc.requiredLimits = &requiredLimits;
     deviceDesc.defaultQueue.nextInChain = nullptr;
     deviceDesc.defaultQueue.label = "Default queue";
+    m_capabilities.configureDeviceDescriptor(deviceDesc);
 
-    m_device = Utils::requestDevice(m_adapter, &deviceDesc);
+    m_device = GpuDevice(Utils::requestDevice(m_adapter, &deviceDesc), resourceCategory);
     if(!m_device) {
-        std::cerr << "Failed to get a device!" << std::endl;
+        Log::error() << "Failed to get a device!";
         throw std::runtime_error("Failed to get a device!");
     }
-    m_queue = wgpuDeviceGetQueue(m_device);
-
-    setWGPUCallbacks(m_device, m_queue);
+    m_capabilities.onDeviceCreated(m_device);
+    Log::info() << "Device capabilities: " << m_capabilities.describe();
+    m_queue = GpuQueue(wgpuDeviceGetQueue(m_device), resourceCategory);
+
+    setWGPUCallbacks(m_device, &m_deviceErrors);
+    m_framePacer = std::make_unique<FramePacer>(m_device, m_queue, m_settings.maxFramesInFlight);
+    m_renderTargets = std::make_unique<RenderTargetPool>(m_device);
+    if (m_capabilities.timestampQuery()) {
+        m_sceneTimer = std::make_unique<GpuTimer>(m_device);
+    }
 
     // Setup swapchain
-    buildSwapchain();
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(m_window, &framebufferWidth, &framebufferHeight);
+    glfwGetWindowSize(m_window, &m_windowSize[0], &m_windowSize[1]);
+    buildSwapchain(framebufferWidth, framebufferHeight);
+
+    if (!m_settings.recordPath.empty()) {
+        // The replay starts from the same settings and window size
+        m_recorder = std::make_unique<InputRecorder>(m_settings.recordPath, m_settings.launchSettings());
+        m_recorder->resize(framebufferWidth, framebufferHeight, m_windowSize[0], m_windowSize[1]);
+    }
 
     // Upload vertex and uniform data to the GPU
     constexpr uint32_t vertexDataSize = 2;
@@ -202,7 +359,7 @@ Application::Application()
     vertexBufferDesc.size = vertexData.size() * sizeof(float);
     vertexBufferDesc.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex;
     vertexBufferDesc.mappedAtCreation = false;
-    m_vertexBuffer = wgpuDeviceCreateBuffer(m_device, &vertexBufferDesc);
+    m_vertexBuffer = createGpuBuffer(m_device, vertexBufferDesc, resourceCategory);
 
     WGPUBufferDescriptor indexBufferDesc{};
     indexBufferDesc.nextInChain = nullptr;
@@ -210,7 +367,7 @@ Application::Application()
     indexBufferDesc.size = indexData.size() * sizeof(uint16_t);
     indexBufferDesc.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Index;
     indexBufferDesc.mappedAtCreation = false;
-    m_indexBuffer = wgpuDeviceCreateBuffer(m_device, &indexBufferDesc);
+    m_indexBuffer = createGpuBuffer(m_device, indexBufferDesc, resourceCategory);
 
     WGPUBufferDescriptor uniformBufferDesc {};
     uniformBufferDesc.nextInChain = nullptr;
@@ -218,12 +375,16 @@ Application::Application()
     uniformBufferDesc.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Uniform;
     uniformBufferDesc.size = sizeof(Uniform);
     uniformBufferDesc.mappedAtCreation = false;
-    m_uniformBuffer = wgpuDeviceCreateBuffer(m_device, &uniformBufferDesc);
+    m_uniformBuffer = createGpuBuffer(m_device, uniformBufferDesc, resourceCategory);
 
     wgpuQueueWriteBuffer(m_queue, m_vertexBuffer, 0, vertexData.data(), vertexBufferDesc.size);
     wgpuQueueWriteBuffer(m_queue, m_indexBuffer, 0, indexData.data(), indexBufferDesc.size);
     wgpuQueueWriteBuffer(m_queue, m_uniformBuffer, 0, &m_uniforms, sizeof(Uniform));
 
+    const ResizeManager::Size size = { framebufferWidth, framebufferHeight, m_windowSize[0], m_windowSize[1] };
+    m_resizeManager = std::make_unique<ResizeManager>(m_device, *m_renderTargets, m_uniformBuffer, sizeof(Uniform),
+                                                      m_swapChainFormat, size);
+
     WGPUVertexAttribute positionAttrib{};
     positionAttrib.shaderLocation = 0;
     positionAttrib.format = WGPUVertexFormat_Float32x2;
@@ -237,51 +398,70 @@ Application::Application()
     vertexBufferLayout.arrayStride = vertexDataSize * sizeof(float);
     vertexBufferLayout.stepMode = WGPUVertexStepMode_Vertex;
 
-    // Create binding group
-    WGPUBindGroupLayoutEntry bindingLayout = Utils::createDefaultBindingLayout();
+    m_iterationBudget = std::make_unique<IterationBudget>(m_device, m_uniformBuffer, sizeof(Uniform));
+
+    // Create binding group: the uniforms, then the per-tile iteration
+    // budgets and their totals
+    std::array<WGPUBindGroupLayoutEntry, 3> bindingLayouts{};
+    WGPUBindGroupLayoutEntry& bindingLayout = bindingLayouts[0];
+    bindingLayout = Utils::createDefaultBindingLayout();
     bindingLayout.nextInChain = nullptr;
     bindingLayout.binding = 0;
     bindingLayout.visibility = WGPUShaderStage_Vertex | WGPUShaderStage_Fragment;
     bindingLayout.buffer.type = WGPUBufferBindingType_Uniform;
     bindingLayout.buffer.minBindingSize = sizeof(Uniform);
+    for (uint32_t i = 1; i < bindingLayouts.size(); ++i) {
+        bindingLayouts[i] = Utils::createDefaultBindingLayout();
+        bindingLayouts[i].nextInChain = nullptr;
+        bindingLayouts[i].binding = i;
+        bindingLayouts[i].visibility = WGPUShaderStage_Fragment;
+        bindingLayouts[i].buffer.type = WGPUBufferBindingType_ReadOnlyStorage;
+        bindingLayouts[i].buffer.minBindingSize = 0;
+    }
 
     WGPUBindGroupLayoutDescriptor bindGroupLayoutDesc {};
     bindGroupLayoutDesc.nextInChain = nullptr;
-    bindGroupLayoutDesc.entryCount = 1;
-    bindGroupLayoutDesc.entries = &bindingLayout;
-    WGPUBindGroupLayout bindingGroupLayout = wgpuDeviceCreateBindGroupLayout(m_device, &bindGroupLayoutDesc);
+    bindGroupLayoutDesc.entryCount = static_cast<uint32_t>(bindingLayouts.size());
+    bindGroupLayoutDesc.entries = bindingLayouts.data();
+    GpuBindGroupLayout bindingGroupLayout(wgpuDeviceCreateBindGroupLayout(m_device, &bindGroupLayoutDesc), resourceCategory);
+    WGPUBindGroupLayout bindGroupLayoutHandle = bindingGroupLayout;
 
     WGPUPipelineLayoutDescriptor pipelineLayoutDesc {};
     pipelineLayoutDesc.nextInChain = nullptr;
     pipelineLayoutDesc.bindGroupLayoutCount = 1;
-    pipelineLayoutDesc.bindGroupLayouts = &bindingGroupLayout;
-    WGPUPipelineLayout pipelineLayout = wgpuDeviceCreatePipelineLayout(m_device, &pipelineLayoutDesc);
+    pipelineLayoutDesc.bindGroupLayouts = &bindGroupLayoutHandle;
+    GpuPipelineLayout pipelineLayout(wgpuDeviceCreatePipelineLayout(m_device, &pipelineLayoutDesc), resourceCategory);
 
-    WGPUBindGroupEntry binding {};
-    binding.nextInChain = nullptr;
-    binding.binding = 0;
-    binding.buffer = m_uniformBuffer;
-    binding.offset = 0;
-    binding.size = sizeof(Uniform);
+    std::array<WGPUBindGroupEntry, 3> bindings = {
+        Utils::bufferBindGroupEntry(0, m_uniformBuffer, sizeof(Uniform)),
+        Utils::bufferBindGroupEntry(1, m_iterationBudget->tileBuffer(), m_iterationBudget->tileBufferSize()),
+        Utils::bufferBindGroupEntry(2, m_iterationBudget->statsBuffer(), m_iterationBudget->statsBufferSize()),
+    };
 
     WGPUBindGroupDescriptor bindGroupDesc {};
     bindGroupDesc.nextInChain = nullptr;
     bindGroupDesc.layout = bindingGroupLayout;
     bindGroupDesc.entryCount = bindGroupLayoutDesc.entryCount;
-    bindGroupDesc.entries = &binding;
-    m_bindGroup = wgpuDeviceCreateBindGroup(m_device, &bindGroupDesc);
+    bindGroupDesc.entries = bindings.data();
+    m_bindGroup = GpuBindGroup(wgpuDeviceCreateBindGroup(m_device, &bindGroupDesc), resourceCategory);
 
 
-    // Load shaders and setup render pipeline
-    m_shaderModule = Utils::loadShaderModule("./shaders/shader.wgsl", m_device);
-    std::cout << "Shader module: " << m_shaderModule << std::endl;
+    // One fractal kernel per arithmetic precision. All of them are built up
+    // front so that switching precision while zooming never stalls a frame.
+    m_precision = PrecisionManager(m_capabilities.shaderF16());
+    constexpr std::array<const char *, PrecisionManager::tierCount> shaderPaths = {
+        "shaders/shader_f16.wgsl",
+        "shaders/shader.wgsl",
+        "shaders/shader_df64.wgsl",
+    };
+    // Shared by the kernels, see IterationBudget
+    constexpr std::array<std::string_view, 1> kernelLibraries = { "shaders/budget.wgsl" };
 
     WGPURenderPipelineDescriptor pipelineDesc{};
     pipelineDesc.nextInChain = nullptr;
 
     pipelineDesc.vertex.bufferCount = 1;
     pipelineDesc.vertex.buffers = &vertexBufferLayout;
-    pipelineDesc.vertex.module = m_shaderModule;
     pipelineDesc.vertex.entryPoint = "vs_main";
     pipelineDesc.vertex.constantCount = 0;
     pipelineDesc.vertex.constants = nullptr;
@@ -294,7 +474,6 @@ Application::Application()
 
     WGPUFragmentState fragmentState {};
     fragmentState.nextInChain = nullptr;
-    fragmentState.module = m_shaderModule;
     fragmentState.entryPoint = "fs_main";
     fragmentState.constantCount = 0;
     fragmentState.constants = nullptr;
@@ -325,13 +504,67 @@ Application::Application()
     pipelineDesc.multisample.mask = ~0u;
     pipelineDesc.multisample.alphaToCoverageEnabled = false;
 
-    m_renderPipeline = wgpuDeviceCreateRenderPipeline(m_device, &pipelineDesc);
-    std::cout << "Render pipeline: " << m_renderPipeline << std::endl;
+    for (size_t i = 0; i < shaderPaths.size(); ++i) {
+        if (!m_precision.isSupported(static_cast<PrecisionManager::Tier>(i))) {
+            continue;
+        }
+        m_shaderModules[i] = GpuShaderModule(Utils::loadShaderModule(shaderPaths[i], m_device, kernelLibraries), resourceCategory);
+        Log::debug() << "Shader module: " << shaderPaths[i] << " " << m_shaderModules[i].get();
+        pipelineDesc.vertex.module = m_shaderModules[i];
+        fragmentState.module = m_shaderModules[i];
+        fragmentState.entryPoint = "fs_main";
+        colorTarget.format = m_swapChainFormat;
+        colorTarget.blend = &blendState;
+        m_renderPipelines[i] = GpuRenderPipeline(wgpuDeviceCreateRenderPipeline(m_device, &pipelineDesc), resourceCategory);
+        Log::debug() << "Render pipeline: " << m_renderPipelines[i].get();
+        m_iterationBudget->createEstimator(static_cast<PrecisionManager::Tier>(i), m_shaderModules[i]);
+
+        // Same kernel writing raw escape times for histogram coloring; float
+        // render targets cannot be blended
+        fragmentState.entryPoint = "fs_iterations";
+        colorTarget.format = HistogramColoring::iterationFormat;
+        colorTarget.blend = nullptr;
+        m_iterationPipelines[i] = GpuRenderPipeline(wgpuDeviceCreateRenderPipeline(m_device, &pipelineDesc), resourceCategory);
+    }
+
+    // The Julia panes draw the f32 kernel with their uniforms selected by a
+    // dynamic offset into the ring
+    constexpr size_t juliaTier = static_cast<size_t>(PrecisionManager::Tier::F32);
+    m_uniformRing = std::make_unique<UniformRing>(m_device, m_queue, sizeof(Uniform), juliaPaneCount,
+                                                  FramePacer::maxSupportedFramesInFlight + 1,
+                                                  m_capabilities.limits().minUniformBufferOffsetAlignment);
+    bindingLayout.buffer.hasDynamicOffset = true;
+    GpuBindGroupLayout juliaBindGroupLayout(wgpuDeviceCreateBindGroupLayout(m_device, &bindGroupLayoutDesc), resourceCategory);
+    bindGroupLayoutHandle = juliaBindGroupLayout;
+    GpuPipelineLayout juliaPipelineLayout(wgpuDeviceCreatePipelineLayout(m_device, &pipelineLayoutDesc), resourceCategory);
+
+    pipelineDesc.layout = juliaPipelineLayout;
+    pipelineDesc.vertex.module = m_shaderModules[juliaTier];
+    fragmentState.module = m_shaderModules[juliaTier];
+    fragmentState.entryPoint = "fs_main";
+    colorTarget.format = m_swapChainFormat;
+    colorTarget.blend = &blendState;
+    m_juliaPipeline = GpuRenderPipeline(wgpuDeviceCreateRenderPipeline(m_device, &pipelineDesc), resourceCategory);
+
+    bindings[0].buffer = m_uniformRing->buffer();
+    bindGroupDesc.layout = juliaBindGroupLayout;
+    m_juliaBindGroup = GpuBindGroup(wgpuDeviceCreateBindGroup(m_device, &bindGroupDesc), resourceCategory);
+
+    m_histogram = std::make_unique<HistogramColoring>(m_device, *m_renderTargets, m_uniformBuffer, sizeof(Uniform),
+                                                      m_swapChainFormat);
+    m_histogram->resize(m_uniforms.windowWidth, m_uniforms.windowHeight);
+    m_buddhabrot = std::make_unique<Buddhabrot>(m_device, m_queue, m_swapChainFormat);
+    m_persistentKernel = std::make_unique<PersistentKernel>(m_device, *m_renderTargets, m_uniformBuffer, sizeof(Uniform),
+                                                            m_swapChainFormat);
+    m_persistentKernel->resize(m_uniforms.windowWidth, m_uniforms.windowHeight);
     m_previousFrameTime = glfwGetTime();
+    m_startTime = m_previousFrameTime;
+    m_startCpuTime = std::clock();
 
     if(!initGui()){
         throw std::runtime_error("Failed to initialize Dear ImGui!");
     }
+    markDirty(DirtyUniforms | DirtyGui);
 }
 
 bool Application::isRunning() const
@@ -339,17 +572,268 @@ bool Application::isRunning() const
     return !glfwWindowShouldClose(m_window);
 }
 
+void Application::waitEvents()
+{
+    if (!m_renderThread.joinable() && needsRedraw()) {
+        glfwPollEvents();
+        return;
+    }
+
+    if (!m_renderThread.joinable()) {
+        // Let the last frame's completion be reported before going idle
+        m_framePacer->waitIdle();
+    }
+    glfwWaitEventsTimeout(m_settings.idleTimeout);
+    if (!m_renderThread.joinable()) {
+        ++m_idleWaits;
+        // Time spent blocked is not part of any frame
+        m_previousFrameTime = glfwGetTime();
+    }
+}
+
+bool Application::needsRedraw() const
+{
+    return m_settings.continuous || m_dirtyFlags != DirtyNone ||
+           !m_inputQueue.empty() || m_viewSnapshots.hasUpdate();
+}
+
+void Application::startRenderThread()
+{
+    m_renderThreadRunning = true;
+    m_renderThread = std::thread([this]() { renderLoop(); });
+}
+
+void Application::stopRenderThread()
+{
+    if (!m_renderThread.joinable()) {
+        return;
+    }
+    m_renderThreadRunning = false;
+    wakeRenderThread();
+    m_renderThread.join();
+
+    if (m_renderThreadError) {
+        std::rethrow_exception(std::exchange(m_renderThreadError, nullptr));
+    }
+}
+
+void Application::renderLoop()
+{
+    try {
+        while (m_renderThreadRunning.load(std::memory_order_acquire)) {
+            // Read the counter before checking for work, so that a wake-up
+            // arriving in between makes wait() return immediately
+            const uint32_t wakeCounter = m_wakeCounter.load(std::memory_order_acquire);
+            if (!needsRedraw()) {
+                m_framePacer->waitIdle();
+                m_wakeCounter.wait(wakeCounter, std::memory_order_acquire);
+                ++m_idleWaits;
+                m_previousFrameTime = glfwGetTime();
+                continue;
+            }
+            onFrame();
+        }
+    }
+    catch (...) {
+        m_renderThreadError = std::current_exception();
+        glfwSetWindowShouldClose(m_window, GLFW_TRUE);
+        glfwPostEmptyEvent();
+    }
+}
+
+void Application::wakeRenderThread()
+{
+    m_wakeCounter.fetch_add(1, std::memory_order_release);
+    m_wakeCounter.notify_one();
+}
+
+void Application::pushInputEvent(const InputEvent& event)
+{
+    if (!m_inputQueue.push(event)) {
+        ++m_droppedInputEvents;
+    }
+    wakeRenderThread();
+}
+
+void Application::publishView()
+{
+    m_viewSnapshots.publish(m_view);
+    wakeRenderThread();
+}
+
+void Application::markDirty(uint32_t flags)
+{
+    m_dirtyFlags |= flags;
+    if (flags & DirtyGui) {
+        m_guiFramesPending = guiSettleFrames;
+    }
+}
+
+void Application::processInputEvents()
+{
+    // Bursts of cursor motion are collapsed into their final position, and
+    // consecutive wheel ticks are summed, before they reach the overlay
+    std::optional<InputEvent> pendingMove;
+    std::optional<InputEvent> pendingScroll;
+    auto flush = [&]() {
+        if (pendingMove) {
+            applyInputEvent(*std::exchange(pendingMove, std::nullopt));
+        }
+        if (pendingScroll) {
+            applyInputEvent(*std::exchange(pendingScroll, std::nullopt));
+        }
+    };
+
+    InputEvent event;
+    while (m_inputQueue.pop(event)) {
+        if (m_frameInputTime < 0.0) {
+            m_frameInputTime = event.time;
+        }
+        if (event.type == InputEvent::Type::MouseMove) {
+            if (pendingScroll) {
+                flush();
+            }
+            pendingMove = event;
+        }
+        else if (event.type == InputEvent::Type::Scroll) {
+            if (pendingMove) {
+                flush();
+            }
+            if (pendingScroll) {
+                pendingScroll->x += event.x;
+                pendingScroll->y += event.y;
+                pendingScroll->time = event.time;
+            }
+            else {
+                pendingScroll = event;
+            }
+        }
+        else {
+            flush();
+            applyInputEvent(event);
+        }
+    }
+    flush();
+
+    if (m_viewSnapshots.update()) {
+        m_renderView = m_viewSnapshots.read();
+        markDirty(DirtyUniforms);
+    }
+}
+
+void Application::updateViewUniforms()
+{
+    const ViewState& view = m_renderView;
+    const double largestDim = std::max(m_uniforms.windowWidth, m_uniforms.windowHeight);
+    const double pixelStep = 5.0 / (view.scale * largestDim);
+    // Pixel (0, 0) lies half a view width left of and 0.35 view widths above
+    // the pan offset; the imaginary axis points up
+    const double originX = (-view.offset[0] / largestDim - 0.5) * 5.0 / view.scale;
+    const double originY = (view.offset[1] / largestDim + 0.35) * 5.0 / view.scale;
+
+    auto splitDouble = [](double value) {
+        const float hi = static_cast<float>(value);
+        return std::array<float, 2>{ hi, static_cast<float>(value - hi) };
+    };
+    const auto [originXHi, originXLo] = splitDouble(originX);
+    const auto [originYHi, originYLo] = splitDouble(originY);
+    m_uniforms.offset = { static_cast<float>(view.offset[0]), static_cast<float>(view.offset[1]) };
+    m_uniforms.scale = static_cast<float>(view.scale);
+    m_uniforms.origin = { originXHi, originXLo, originYHi, originYLo };
+    m_uniforms.pixelStep = splitDouble(pixelStep);
+
+    const double centerX = originX + pixelStep * m_uniforms.windowWidth / 2.0;
+    const double centerY = originY - pixelStep * m_uniforms.windowHeight / 2.0;
+    m_precision.update(pixelStep, std::max(std::abs(centerX), std::abs(centerY)), m_uniforms.max_iter);
+}
+
+void Application::applyInputEvent(const InputEvent& event)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    switch (event.type) {
+    case InputEvent::Type::MouseMove:
+        io.AddMousePosEvent(static_cast<float>(event.x), static_cast<float>(event.y));
+        m_cursorPosition = { event.x, event.y };
+        break;
+    case InputEvent::Type::MouseButton:
+        if (event.a >= 0 && event.a < 5) {
+            io.AddMouseButtonEvent(event.a, event.b == GLFW_PRESS);
+        }
+        // Right click pins the point under the cursor into the next pane
+        if (m_showJuliaPanes && event.a == GLFW_MOUSE_BUTTON_RIGHT && event.b == GLFW_PRESS &&
+            !io.WantCaptureMouse) {
+            m_juliaPoints[m_nextPinnedPane] = m_juliaPoints[0];
+            m_pinnedJuliaPanes = std::min(m_pinnedJuliaPanes + 1, juliaPaneCount - 1);
+            m_nextPinnedPane = m_nextPinnedPane % (juliaPaneCount - 1) + 1;
+        }
+        break;
+    case InputEvent::Type::Scroll:
+        io.AddMouseWheelEvent(static_cast<float>(event.x), static_cast<float>(event.y));
+        break;
+    case InputEvent::Type::Key: {
+        const bool down = event.b != GLFW_RELEASE;
+        io.AddKeyEvent(ImGuiMod_Ctrl, (event.c & GLFW_MOD_CONTROL) != 0);
+        io.AddKeyEvent(ImGuiMod_Shift, (event.c & GLFW_MOD_SHIFT) != 0);
+        io.AddKeyEvent(ImGuiMod_Alt, (event.c & GLFW_MOD_ALT) != 0);
+        io.AddKeyEvent(ImGuiMod_Super, (event.c & GLFW_MOD_SUPER) != 0);
+        const ImGuiKey key = glfwKeyToImGuiKey(event.a);
+        if (key != ImGuiKey_None) {
+            io.AddKeyEvent(key, down);
+        }
+        break;
+    }
+    case InputEvent::Type::Char:
+        io.AddInputCharacter(static_cast<unsigned int>(event.a));
+        break;
+    case InputEvent::Type::Focus:
+        io.AddFocusEvent(event.a != 0);
+        break;
+    case InputEvent::Type::CursorLeave:
+        io.AddMousePosEvent(-FLT_MAX, -FLT_MAX);
+        m_cursorPosition = { -1.0, -1.0 };
+        break;
+    case InputEvent::Type::Resize:
+        // Applied by onFrame() once the size settles
+        m_resizeManager->request({ event.a, event.b, static_cast<int>(event.x), static_cast<int>(event.y) },
+                                 currentTime());
+        markDirty(DirtyResize);
+        break;
+    case InputEvent::Type::Refresh:
+        markDirty(DirtyResize);
+        break;
+    }
+    markDirty(DirtyGui);
+}
+
+double Application::currentTime() const
+{
+    return m_replaying ? m_replayTime : glfwGetTime();
+}
+
 void Application::onFrame()
 {
-    double currentFrameTime = glfwGetTime();
+    // Wait for the GPU before sampling input, so that the frame reflects the
+    // newest input rather than input that was queued up behind older frames
+    m_framePacer->waitForFrameSlot();
+    processInputEvents();
+
+    double currentFrameTime = currentTime();
     double deltaTime = currentFrameTime - m_previousFrameTime;
     m_previousFrameTime = currentFrameTime;
     m_frameTimesList.push_back(1.0f / static_cast<float>(deltaTime));
 
-    glfwPollEvents();
+    // The swap chain and the render targets only follow the window once it
+    // stopped changing size
+    if (const std::optional<ResizeManager::Size> size = m_resizeManager->takeSettledSize(currentFrameTime)) {
+        m_windowSize = { size->windowWidth, size->windowHeight };
+        buildSwapchain(size->framebufferWidth, size->framebufferHeight);
+        markDirty(DirtyUniforms);
+    }
+    const bool resizing = m_resizeManager->isResizing();
+
     WGPUTextureView nextTexture = wgpuSwapChainGetCurrentTextureView(m_swapChain);
     if (!nextTexture) {
-        std::cerr << "Cannot acquire next swap chain texture" << std::endl;
+        Log::warning() << "Cannot acquire next swap chain texture";
         return;
     }
 
@@ -358,6 +842,18 @@ void Application::onFrame()
     commandEncoderDesc.label = "Command Encoder";
     WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(m_device, &commandEncoderDesc);
 
+    // While resizing, the previous scene is presented again and stretched to
+    // the window by the presentation engine
+    if (!resizing) {
+        if (m_timeScene) {
+            m_sceneTimer->begin(encoder);
+        }
+        encodeScene(encoder);
+        if (m_timeScene) {
+            m_sceneTimer->end(encoder);
+        }
+    }
+
     WGPURenderPassColorAttachment renderPassColorAttachment{};
     renderPassColorAttachment.view = nextTexture;
     renderPassColorAttachment.resolveTarget = nullptr;
@@ -372,27 +868,11 @@ void Application::onFrame()
     renderPassDesc.depthStencilAttachment = nullptr;
     renderPassDesc.timestampWrites = nullptr;
 
-    // Update uniform buffer
-//    float t = static_cast<float>(glfwGetTime()) * 2;
-//    m_uniforms.scale = std::abs(std::sin(t/12));
-
-//    std::cout << "Uniforms: \n";
-//    std::cout << "  scale: " << m_uniforms.scale << std::endl;
-//    std::cout <<  " center: " << m_uniforms.center[0] << ", " << m_uniforms.center[1] << std::endl;
-//    std::cout << "  width: " << m_uniforms.windowWidth << std::endl;
-//    std::cout << " height: " << m_uniforms.windowHeight << std::endl;
-
-    wgpuQueueWriteBuffer(m_queue, m_uniformBuffer, 0, &m_uniforms, sizeof(Uniform));
-
     WGPURenderPassEncoder renderPass = wgpuCommandEncoderBeginRenderPass(encoder, &renderPassDesc);
-    wgpuRenderPassEncoderSetPipeline(renderPass, m_renderPipeline);
-    wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, m_vertexBuffer, 0, m_vertexCount * 2 * sizeof(float));
-    wgpuRenderPassEncoderSetIndexBuffer(renderPass, m_indexBuffer, WGPUIndexFormat_Uint16, 0, m_indexCount * sizeof(uint16_t));
-    wgpuRenderPassEncoderSetBindGroup(renderPass, 0, m_bindGroup, 0, nullptr);
-    wgpuRenderPassEncoderDrawIndexed(renderPass, m_indexCount, 1, 0, 0, 0);
-    updateGui(renderPass);
+    m_resizeManager->presentScene(renderPass);
+    updateGui(renderPass, static_cast<float>(deltaTime));
     wgpuRenderPassEncoderEnd(renderPass);
-
+    wgpuRenderPassEncoderRelease(renderPass);
 
     wgpuTextureViewRelease(nextTexture);
 
@@ -401,21 +881,616 @@ void Application::onFrame()
     cmdBufferDescriptor.label = "Command buffer";
 
     WGPUCommandBuffer command = wgpuCommandEncoderFinish(encoder, &cmdBufferDescriptor);
+    wgpuCommandEncoderRelease(encoder);
     wgpuQueueSubmit(m_queue, 1, &command);
+    wgpuCommandBufferRelease(command);
+    m_iterationBudget->onSubmitted();
+    m_framePacer->onFrameSubmitted(m_frameInputTime);
+    m_frameInputTime = -1.0;
     wgpuSwapChainPresent(m_swapChain);
 
     // Check for pending errors
     wgpuDeviceTick(m_device);
+    if (m_deviceErrors.load(std::memory_order_relaxed) > 0) {
+        throw std::runtime_error("Uncaptured device error, see the log");
+    }
+
+    ++m_renderedFrames;
+    // Keep presenting until the new size is applied
+    if (resizing) {
+        m_dirtyFlags |= DirtyResize;
+    }
+    if (m_guiFramesPending > 0 && --m_guiFramesPending == 0) {
+        m_dirtyFlags &= ~DirtyGui;
+    }
+}
+
+void Application::encodeScene(WGPUCommandEncoder encoder)
+{
+    WGPURenderPassColorAttachment renderPassColorAttachment{};
+    renderPassColorAttachment.view = m_resizeManager->sceneTarget();
+    renderPassColorAttachment.resolveTarget = nullptr;
+    renderPassColorAttachment.loadOp = WGPULoadOp_Clear;
+    renderPassColorAttachment.storeOp = WGPUStoreOp_Store;
+    renderPassColorAttachment.clearValue = WGPUColor{ 0.0, 0.1, 0.2, 1.0 };
+
+    WGPURenderPassDescriptor renderPassDesc{};
+    renderPassDesc.nextInChain = nullptr;
+    renderPassDesc.colorAttachmentCount = 1;
+    renderPassDesc.colorAttachments = &renderPassColorAttachment;
+    renderPassDesc.depthStencilAttachment = nullptr;
+    renderPassDesc.timestampWrites = nullptr;
+
+    // Pooled targets can be larger than the window, which covers their top
+    // left corner
+    const float width = static_cast<float>(m_uniforms.windowWidth);
+    const float height = static_cast<float>(m_uniforms.windowHeight);
+
+    // Only upload the uniforms when the view actually changed
+    const bool viewChanged = (m_dirtyFlags & DirtyUniforms) != 0;
+    if (viewChanged) {
+        updateViewUniforms();
+        wgpuQueueWriteBuffer(m_queue, m_uniformBuffer, 0, &m_uniforms, sizeof(Uniform));
+    }
+    // Flags raised while recording this frame (e.g. by the overlay) are kept
+    // for the next one
+    m_dirtyFlags &= ~(DirtyUniforms | DirtyResize);
+
+    const auto precisionTier = static_cast<size_t>(m_precision.tier());
+    // The persistent kernel only has an f32 variant, other precisions are
+    // drawn by the fragment kernel
+    RenderMode renderMode = m_renderMode;
+    if (renderMode == RenderMode::EscapeTimeCompute && m_precision.tier() != PrecisionManager::Tier::F32) {
+        renderMode = RenderMode::EscapeTime;
+    }
+    // The budgets only depend on the view, so they are estimated again only
+    // when it changes
+    const bool fragmentKernel = renderMode == RenderMode::EscapeTime || renderMode == RenderMode::Histogram;
+    if (m_uniforms.adaptiveBudget != 0.0F && viewChanged && fragmentKernel) {
+        m_iterationBudget->encode(encoder, m_precision.tier(), static_cast<uint32_t>(m_uniforms.windowWidth),
+                                  static_cast<uint32_t>(m_uniforms.windowHeight));
+    }
+    if (renderMode == RenderMode::Histogram) {
+        WGPURenderPassColorAttachment iterationAttachment{};
+        iterationAttachment.view = m_histogram->iterationTarget();
+        iterationAttachment.resolveTarget = nullptr;
+        iterationAttachment.loadOp = WGPULoadOp_Clear;
+        iterationAttachment.storeOp = WGPUStoreOp_Store;
+        iterationAttachment.clearValue = WGPUColor{ 0.0, 0.0, 0.0, 0.0 };
+
+        WGPURenderPassDescriptor iterationPassDesc = renderPassDesc;
+        iterationPassDesc.colorAttachments = &iterationAttachment;
+        WGPURenderPassEncoder iterationPass = wgpuCommandEncoderBeginRenderPass(encoder, &iterationPassDesc);
+        wgpuRenderPassEncoderSetViewport(iterationPass, 0.0F, 0.0F, width, height, 0.0F, 1.0F);
+        drawFractal(iterationPass, m_iterationPipelines[precisionTier]);
+        wgpuRenderPassEncoderEnd(iterationPass);
+        wgpuRenderPassEncoderRelease(iterationPass);
+
+        m_histogram->encode(encoder);
+    }
+    else if (renderMode == RenderMode::EscapeTimeCompute) {
+        m_persistentKernel->encode(encoder);
+    }
+    else if (renderMode == RenderMode::Buddhabrot) {
+        m_buddhabrot->configure(static_cast<uint32_t>(m_uniforms.windowWidth),
+                                static_cast<uint32_t>(m_uniforms.windowHeight),
+                                static_cast<uint32_t>(m_uniforms.max_iter));
+        m_buddhabrot->encode(encoder);
+    }
+    // Keep rendering until the orbit density has converged
+    if (renderMode == RenderMode::Buddhabrot && m_buddhabrot->isAccumulating()) {
+        m_dirtyFlags |= DirtyProgressive;
+    }
+    else {
+        m_dirtyFlags &= ~DirtyProgressive;
+    }
+
+    WGPURenderPassEncoder renderPass = wgpuCommandEncoderBeginRenderPass(encoder, &renderPassDesc);
+    wgpuRenderPassEncoderSetViewport(renderPass, 0.0F, 0.0F, width, height, 0.0F, 1.0F);
+    if (renderMode == RenderMode::Histogram) {
+        m_histogram->draw(renderPass);
+    }
+    else if (renderMode == RenderMode::EscapeTimeCompute) {
+        m_persistentKernel->draw(renderPass);
+    }
+    else if (renderMode == RenderMode::Buddhabrot) {
+        m_buddhabrot->draw(renderPass);
+    }
+    else {
+        drawFractal(renderPass, m_renderPipelines[precisionTier]);
+    }
+    if (m_showJuliaPanes) {
+        drawJuliaPanes(renderPass);
+    }
+    wgpuRenderPassEncoderEnd(renderPass);
+    wgpuRenderPassEncoderRelease(renderPass);
+}
+
+void Application::drawFractal(WGPURenderPassEncoder pass, WGPURenderPipeline pipeline)
+{
+    wgpuRenderPassEncoderSetPipeline(pass, pipeline);
+    wgpuRenderPassEncoderSetVertexBuffer(pass, 0, m_vertexBuffer, 0, m_vertexCount * 2 * sizeof(float));
+    wgpuRenderPassEncoderSetIndexBuffer(pass, m_indexBuffer, WGPUIndexFormat_Uint16, 0, m_indexCount * sizeof(uint16_t));
+    wgpuRenderPassEncoderSetBindGroup(pass, 0, m_bindGroup, 0, nullptr);
+    wgpuRenderPassEncoderDrawIndexed(pass, m_indexCount, 1, 0, 0, 0);
+}
+
+std::array<double, 2> Application::complexAt(double windowX, double windowY) const
+{
+    const double framebufferScale = m_windowSize[0] > 0 ? static_cast<double>(m_uniforms.windowWidth) / m_windowSize[0] : 1.0;
+    const double pixelStep = double(m_uniforms.pixelStep[0]) + m_uniforms.pixelStep[1];
+    const double originX = double(m_uniforms.origin[0]) + m_uniforms.origin[1];
+    const double originY = double(m_uniforms.origin[2]) + m_uniforms.origin[3];
+    return { originX + windowX * framebufferScale * pixelStep,
+             originY - windowY * framebufferScale * pixelStep };
+}
+
+void Application::drawJuliaPanes(WGPURenderPassEncoder pass)
+{
+    // Square panes along the bottom edge, right to left
+    constexpr double juliaExtent = 3.2;
+    const float paneSize = std::min(m_uniforms.windowHeight / 4.0F, m_uniforms.windowWidth / (juliaPaneCount + 1.0F));
+    const float margin = paneSize / 16.0F;
+    const size_t paneCount = 1 + m_pinnedJuliaPanes;
+    if (paneSize < 1.0F) {
+        return;
+    }
+
+    // Follow the cursor while it is over the main view
+    const float framebufferScale = m_windowSize[0] > 0 ? static_cast<float>(m_uniforms.windowWidth) / m_windowSize[0] : 1.0F;
+    const float cursorX = static_cast<float>(m_cursorPosition[0]) * framebufferScale;
+    const float cursorY = static_cast<float>(m_cursorPosition[1]) * framebufferScale;
+    const bool overPanes = cursorY >= m_uniforms.windowHeight - paneSize - 2.0F * margin &&
+                           cursorX >= m_uniforms.windowWidth - paneCount * (paneSize + margin) - margin;
+    if (m_cursorPosition[0] >= 0.0 && !overPanes && !m_guiWantsMouse.load(std::memory_order_relaxed)) {
+        m_juliaPoints[0] = complexAt(m_cursorPosition[0], m_cursorPosition[1]);
+    }
+
+    m_uniformRing->beginFrame();
+    wgpuRenderPassEncoderSetPipeline(pass, m_juliaPipeline);
+    wgpuRenderPassEncoderSetVertexBuffer(pass, 0, m_vertexBuffer, 0, m_vertexCount * 2 * sizeof(float));
+    wgpuRenderPassEncoderSetIndexBuffer(pass, m_indexBuffer, WGPUIndexFormat_Uint16, 0, m_indexCount * sizeof(uint16_t));
+    for (size_t pane = 0; pane < paneCount; ++pane) {
+        const float x = m_uniforms.windowWidth - (pane + 1) * (paneSize + margin);
+        const float y = m_uniforms.windowHeight - paneSize - margin;
+
+        // Fragment positions are framebuffer coordinates, so the origin is
+        // placed such that the pane shows [-1.6, 1.6] on both axes
+        const double pixelStep = juliaExtent / paneSize;
+        Uniform uniform = m_uniforms;
+        uniform.julia = 1.0F;
+        uniform.juliaC = { static_cast<float>(m_juliaPoints[pane][0]), static_cast<float>(m_juliaPoints[pane][1]) };
+        uniform.origin = { static_cast<float>(-juliaExtent / 2.0 - x * pixelStep), 0.0F,
+                           static_cast<float>(juliaExtent / 2.0 + y * pixelStep), 0.0F };
+        uniform.pixelStep = { static_cast<float>(pixelStep), 0.0F };
+
+        const uint32_t offset = m_uniformRing->push(&uniform);
+        wgpuRenderPassEncoderSetViewport(pass, x, y, paneSize, paneSize, 0.0F, 1.0F);
+        wgpuRenderPassEncoderSetBindGroup(pass, 0, m_juliaBindGroup, 1, &offset);
+        wgpuRenderPassEncoderDrawIndexed(pass, m_indexCount, 1, 0, 0, 0);
+    }
+    // One upload for all panes, ordered before the submit of this frame
+    m_uniformRing->flush();
+    wgpuRenderPassEncoderSetViewport(pass, 0.0F, 0.0F, static_cast<float>(m_uniforms.windowWidth),
+                                     static_cast<float>(m_uniforms.windowHeight), 0.0F, 1.0F);
+}
+
+void Application::runBenchmark(const std::string& name)
+{
+    if (m_sceneTimer) {
+        Log::info() << "GPU times of the scene passes from timestamp queries";
+    }
+    else {
+        Log::info() << "GPU times from submission to completion of whole frames, timestamp queries are not available";
+    }
+    if (name == "precision") {
+        runPrecisionBenchmark();
+    }
+    else if (name == "divergence") {
+        runDivergenceBenchmark();
+    }
+    else if (name == "budget") {
+        runBudgetBenchmark();
+    }
+    else {
+        throw std::runtime_error("Unknown benchmark: " + name);
+    }
+}
+
+Application::ViewState Application::viewCenteredAt(double x, double y, double scale) const
+{
+    // Inverse of the origin computation in updateViewUniforms()
+    const double largestDim = std::max(m_uniforms.windowWidth, m_uniforms.windowHeight);
+    ViewState view;
+    view.scale = scale;
+    view.offset = { largestDim * (-x * scale / 5.0 - 0.5) + m_uniforms.windowWidth / 2.0,
+                    largestDim * (y * scale / 5.0 - 0.35) + m_uniforms.windowHeight / 2.0 };
+    return view;
+}
+
+double Application::measureGpuFrameTime()
+{
+    constexpr int warmupFrames = 10;
+    constexpr int measuredFrames = 100;
+
+    // Timestamps around the scene passes leave out the present pass and the
+    // overlay. Without them, one frame at a time, so that submit-to-completion
+    // is the GPU time.
+    m_timeScene = m_sceneTimer != nullptr;
+    double sceneMs = 0.0;
+    for (int frame = 0; frame < warmupFrames + measuredFrames; ++frame) {
+        if (frame == warmupFrames) {
+            m_framePacer->resetStats();
+        }
+        markDirty(DirtyUniforms);
+        onFrame();
+        m_framePacer->waitIdle();
+        if (m_timeScene && frame >= warmupFrames) {
+            sceneMs += m_sceneTimer->read();
+        }
+    }
+    if (std::exchange(m_timeScene, false)) {
+        return sceneMs / measuredFrames;
+    }
+    return m_framePacer->averageGpuTimeMs();
+}
+
+std::vector<float> Application::readIterationCounts()
+{
+    const RenderMode previousMode = m_renderMode;
+    m_renderMode = RenderMode::Histogram;
+    markDirty(DirtyUniforms);
+    onFrame();
+    m_framePacer->waitIdle();
+    m_renderMode = previousMode;
+
+    const auto width = static_cast<uint32_t>(m_uniforms.windowWidth);
+    const auto height = static_cast<uint32_t>(m_uniforms.windowHeight);
+    // Rows of texture copies are aligned to 256 bytes
+    const uint32_t bytesPerRow = (width * sizeof(float) + 255) / 256 * 256;
+
+    WGPUBufferDescriptor bufferDesc{};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.label = "Iteration readback";
+    bufferDesc.size = static_cast<uint64_t>(bytesPerRow) * height;
+    bufferDesc.usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+    bufferDesc.mappedAtCreation = false;
+    const GpuBuffer readback = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+
+    WGPUImageCopyTexture source{};
+    source.nextInChain = nullptr;
+    source.texture = m_histogram->iterationTexture();
+    source.mipLevel = 0;
+    source.origin = { 0, 0, 0 };
+    source.aspect = WGPUTextureAspect_All;
+    WGPUImageCopyBuffer destination{};
+    destination.nextInChain = nullptr;
+    destination.buffer = readback;
+    destination.layout.offset = 0;
+    destination.layout.bytesPerRow = bytesPerRow;
+    destination.layout.rowsPerImage = height;
+    const WGPUExtent3D copySize = { width, height, 1 };
+
+    WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(m_device, nullptr);
+    wgpuCommandEncoderCopyTextureToBuffer(encoder, &source, &destination, &copySize);
+    WGPUCommandBuffer command = wgpuCommandEncoderFinish(encoder, nullptr);
+    wgpuCommandEncoderRelease(encoder);
+    wgpuQueueSubmit(m_queue, 1, &command);
+    wgpuCommandBufferRelease(command);
+
+    if (!Utils::mapBufferAndWait(m_device, readback, WGPUMapMode_Read, bufferDesc.size)) {
+        throw std::runtime_error("Failed to read back the iteration counts");
+    }
+
+    std::vector<float> counts(static_cast<size_t>(width) * height);
+    const auto *data = static_cast<const char *>(wgpuBufferGetConstMappedRange(readback, 0, bufferDesc.size));
+    for (uint32_t y = 0; y < height; ++y) {
+        std::memcpy(counts.data() + static_cast<size_t>(y) * width, data + static_cast<size_t>(y) * bytesPerRow,
+                    width * sizeof(float));
+    }
+    wgpuBufferUnmap(readback);
+    return counts;
+}
+
+void Application::runPrecisionBenchmark()
+{
+    const std::optional<PrecisionManager::Tier> previousTier = m_precision.forcedTier();
+    Log::info() << "Precision benchmark at zoom " << m_renderView.scale << ", "
+                << m_uniforms.windowWidth << "x" << m_uniforms.windowHeight << ", "
+                << m_uniforms.max_iter << " max iterations";
+
+    for (int i = 0; i < PrecisionManager::tierCount; ++i) {
+        const auto tier = static_cast<PrecisionManager::Tier>(i);
+        if (!m_precision.isSupported(tier)) {
+            Log::info() << "  " << PrecisionManager::tierName(tier) << ": not supported";
+            continue;
+        }
+        m_precision.setForcedTier(tier);
+
+        const double gpuMs = measureGpuFrameTime();
+        const double pixels = static_cast<double>(m_uniforms.windowWidth) * m_uniforms.windowHeight;
+        Log::info() << "  " << PrecisionManager::tierName(tier) << ": " << gpuMs << " ms/frame, "
+                    << pixels / (gpuMs * 1000.0) << " Mpixel/s";
+    }
+
+    m_precision.setForcedTier(previousTier);
+    markDirty(DirtyUniforms);
+}
+
+void Application::runDivergenceBenchmark()
+{
+    const ViewState previousView = m_renderView;
+    const RenderMode previousMode = m_renderMode;
+    const std::optional<PrecisionManager::Tier> previousTier = m_precision.forcedTier();
+    // The persistent kernel only has an f32 variant
+    m_precision.setForcedTier(PrecisionManager::Tier::F32);
+
+    Log::info() << "Divergence benchmark at " << m_uniforms.windowWidth << "x" << m_uniforms.windowHeight
+                << ", " << m_uniforms.max_iter << " max iterations, "
+                << m_persistentKernel->workgroupCount() << " persistent workgroups";
+    for (const BenchmarkView& view : benchmarkViews) {
+        m_renderView = viewCenteredAt(view.x, view.y, view.scale);
+        m_renderMode = RenderMode::EscapeTime;
+        const double fragmentMs = measureGpuFrameTime();
+        m_renderMode = RenderMode::EscapeTimeCompute;
+        const double computeMs = measureGpuFrameTime();
+        Log::info() << "  " << view.name << ": fragment " << fragmentMs << " ms/frame, persistent compute "
+                    << computeMs << " ms/frame (" << fragmentMs / computeMs << "x)";
+    }
+
+    m_renderView = previousView;
+    m_renderMode = previousMode;
+    m_precision.setForcedTier(previousTier);
+    markDirty(DirtyUniforms);
+}
+
+void Application::runBudgetBenchmark()
+{
+    const ViewState previousView = m_renderView;
+    const RenderMode previousMode = m_renderMode;
+    const float previousAdaptive = m_uniforms.adaptiveBudget;
+    m_renderMode = RenderMode::EscapeTime;
+
+    Log::info() << "Iteration budget benchmark at " << m_uniforms.windowWidth << "x" << m_uniforms.windowHeight
+                << ", " << m_uniforms.max_iter << " max iterations, "
+                << PrecisionManager::tierName(m_precision.tier()) << " precision";
+    for (const BenchmarkView& view : benchmarkViews) {
+        m_renderView = viewCenteredAt(view.x, view.y, view.scale);
+        m_uniforms.adaptiveBudget = 0.0F;
+        const double fixedMs = measureGpuFrameTime();
+        const std::vector<float> fixedCounts = readIterationCounts();
+        m_uniforms.adaptiveBudget = 1.0F;
+        const double adaptiveMs = measureGpuFrameTime();
+        const std::vector<float> adaptiveCounts = readIterationCounts();
+
+        const IterationBudget::Stats& budget = m_iterationBudget->stats();
+        const double maxBudget = m_uniforms.max_iter +
+            std::max(static_cast<double>(budget.maxDemand) - m_uniforms.max_iter, 0.0) * budget.boostScale();
+        Log::info() << "  " << view.name << ": fixed " << fixedMs << " ms/frame, adaptive " << adaptiveMs
+                    << " ms/frame including the estimate, " << budget.boundaryTiles << " boundary tiles up to "
+                    << maxBudget << " iterations (" << 100.0 * budget.boostScale() << "% of the requested boost)";
+
+        // Capped at max_iterations, escape times must match the fixed budget
+        size_t differing = 0;
+        for (size_t i = 0; i < fixedCounts.size(); ++i) {
+            differing += fixedCounts[i] != adaptiveCounts[i] ? 1 : 0;
+        }
+        if (differing > 0) {
+            Log::warning() << "  " << view.name << ": " << differing << " of " << fixedCounts.size()
+                           << " pixels have other escape times than with the fixed budget";
+        }
+    }
+
+    m_renderView = previousView;
+    m_renderMode = previousMode;
+    m_uniforms.adaptiveBudget = previousAdaptive;
+    markDirty(DirtyUniforms);
+}
+
+void Application::runReplay(const InputTrace& trace, const std::string& path)
+{
+    const std::vector<InputTrace::Event>& events = trace.events();
+    const double frameTime = 1.0 / m_settings.replayFrameRate;
+    Log::info() << "Replaying " << events.size() << " events (" << trace.duration() << " s) from "
+                << path << " at " << m_settings.replayFrameRate << " frames/s";
+
+    if (!trace.launchSettings()) {
+        Log::warning() << "The trace has no launch settings, replaying with the command line ones";
+    }
+    else if (trace.launchSettings()->renderThread) {
+        // Only the thread that records the frames differs, not their work
+        Log::info() << "The recorded run used a render thread, the replay renders on the calling thread";
+    }
+
+    struct FrameTiming {
+        uint64_t frame = 0;
+        double time = 0.0;
+        size_t events = 0;
+        double cpuMs = 0.0;
+        double gpuMs = 0.0;
+    };
+    std::vector<FrameTiming> timings;
+    m_replaying = true;
+    m_previousFrameTime = -frameTime;
+    size_t next = 0;
+    for (uint64_t frame = 0; next < events.size() || frame * frameTime <= trace.duration(); ++frame) {
+        FrameTiming timing;
+        timing.frame = frame;
+        timing.time = frame * frameTime;
+        m_replayTime = timing.time;
+        while (next < events.size() && events[next].time <= m_replayTime) {
+            replayEvent(events[next++]);
+            ++timing.events;
+        }
+        // The window is hidden and has no callbacks, but the platform still
+        // expects its queue to be pumped
+        glfwPollEvents();
+        // Without --continuous the recorded run only rendered on changes
+        if (!needsRedraw()) {
+            continue;
+        }
+
+        // One frame at a time, so that submit-to-completion is the GPU time
+        const auto start = std::chrono::steady_clock::now();
+        onFrame();
+        timing.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        m_framePacer->waitIdle();
+        timing.gpuMs = m_framePacer->lastGpuTimeMs();
+        timings.push_back(timing);
+    }
+    m_replaying = false;
+
+    const std::string reportPath = path + ".csv";
+    std::ofstream report(reportPath);
+    report << "frame,time,events,cpu_ms,gpu_ms\n";
+    std::vector<double> cpuMs;
+    std::vector<double> gpuMs;
+    for (const FrameTiming& timing : timings) {
+        report << timing.frame << ',' << timing.time << ',' << timing.events << ','
+               << timing.cpuMs << ',' << timing.gpuMs << '\n';
+        cpuMs.push_back(timing.cpuMs);
+        gpuMs.push_back(timing.gpuMs);
+    }
+    if (!report) {
+        throw std::runtime_error("Failed to write the replay report: " + reportPath);
+    }
+
+    auto printSummary = [](const char *name, const std::vector<double>& values) {
+        const double mean = values.empty() ? 0.0 : std::reduce(values.begin(), values.end()) / values.size();
+        Log::info() << "  " << name << ": mean " << mean << " ms, p50 " << percentile(values, 0.5)
+                    << " ms, p95 " << percentile(values, 0.95) << " ms, max "
+                    << (values.empty() ? 0.0 : *std::max_element(values.begin(), values.end())) << " ms";
+    };
+    Log::info() << "Replayed " << timings.size() << " frames, report written to " << reportPath;
+    printSummary("CPU time per frame", cpuMs);
+    printSummary("GPU time per frame", gpuMs);
+}
+
+void Application::replayEvent(const InputTrace::Event& event)
+{
+    switch (event.type) {
+    case InputTrace::EventType::MouseMove:
+        onMouseMove(event.x, event.y);
+        break;
+    case InputTrace::EventType::Scroll:
+        onScroll(event.x, event.y);
+        break;
+    case InputTrace::EventType::MouseButton:
+        handleMouseButton(event.ints[0], event.ints[1], event.ints[2], event.x, event.y, event.ints[3] != 0);
+        break;
+    case InputTrace::EventType::Resize:
+        glfwSetWindowSize(m_window, event.ints[2], event.ints[3]);
+        handleResize(event.ints[0], event.ints[1], event.ints[2], event.ints[3]);
+        break;
+    case InputTrace::EventType::Setting:
+        if (event.ints[0] <= static_cast<int32_t>(Setting::PrecisionSafetyFactor)) {
+            applySetting(static_cast<Setting>(event.ints[0]), event.value);
+        }
+        break;
+    }
+}
+
+void Application::changeSetting(Setting setting, double value)
+{
+    // Replays apply the recorded changes instead
+    if (m_replaying) {
+        return;
+    }
+    if (m_recorder) {
+        m_recorder->setting(static_cast<uint8_t>(setting), value);
+    }
+    applySetting(setting, value);
+}
+
+void Application::applySetting(Setting setting, double value)
+{
+    switch (setting) {
+    case Setting::FramesInFlight:
+        m_framePacer->setMaxFramesInFlight(static_cast<uint32_t>(value));
+        break;
+    case Setting::MaxIterations:
+        m_uniforms.max_iter = static_cast<float>(value);
+        break;
+    case Setting::AdaptiveBudget:
+        m_uniforms.adaptiveBudget = value != 0.0 ? 1.0F : 0.0F;
+        break;
+    case Setting::RenderMode:
+        m_renderMode = static_cast<RenderMode>(std::clamp(static_cast<int>(value), 0, static_cast<int>(RenderMode::Buddhabrot)));
+        break;
+    case Setting::JuliaPanes:
+        m_showJuliaPanes = value != 0.0;
+        break;
+    case Setting::PersistentWorkgroups:
+        m_persistentKernel->setWorkgroupCount(static_cast<uint32_t>(value));
+        break;
+    case Setting::BuddhabrotGamma:
+        m_buddhabrot->setGamma(static_cast<float>(value));
+        break;
+    case Setting::PrecisionMode:
+        if (value < 1.0) {
+            m_precision.setForcedTier(std::nullopt);
+        }
+        else {
+            m_precision.setForcedTier(static_cast<PrecisionManager::Tier>(
+                std::min(static_cast<int>(value) - 1, PrecisionManager::tierCount - 1)));
+        }
+        break;
+    case Setting::PrecisionSafetyFactor:
+        m_precision.setSafetyFactor(static_cast<float>(value));
+        break;
+    }
+    markDirty(DirtyUniforms);
 }
 
 void Application::onFinish()
 {
+    double wallTime = glfwGetTime() - m_startTime;
+    double cpuTime = static_cast<double>(std::clock() - m_startCpuTime) / CLOCKS_PER_SEC;
+    Log::info() << "Rendered " << m_renderedFrames << " frames in " << wallTime << " s ("
+                << m_idleWaits << " idle waits)";
+    if (m_recorder) {
+        Log::info() << "Recorded " << m_recorder->eventCount() << " input events to "
+                    << m_settings.recordPath;
+        m_recorder.reset();
+    }
+    if (m_droppedInputEvents > 0) {
+        Log::info() << "Dropped " << m_droppedInputEvents << " input events";
+    }
+    Log::info() << "CPU time: " << cpuTime << " s (" << 100.0 * cpuTime / wallTime
+                << "% of one core)";
+    FramePacer::LatencyStats latency = m_framePacer->inputLatency();
+    Log::info() << "Input to GPU completion latency: average " << latency.averageMs
+                << " ms, p95 " << latency.p95Ms << " ms (last " << latency.sampleCount
+                << " input frames)";
+    m_framePacer.reset();
+    m_histogram.reset();
+    m_buddhabrot.reset();
+    m_persistentKernel.reset();
+    m_iterationBudget.reset();
+    m_sceneTimer.reset();
+    m_resizeManager.reset();
+    m_renderTargets.reset();
+    m_juliaBindGroup.reset();
+    m_juliaPipeline.reset();
+    m_uniformRing.reset();
+    for (size_t i = 0; i < m_shaderModules.size(); ++i) {
+        m_iterationPipelines[i].reset();
+        m_renderPipelines[i].reset();
+        m_shaderModules[i].reset();
+    }
+    m_bindGroup.reset();
+    m_uniformBuffer.reset();
+    m_indexBuffer.reset();
+    m_vertexBuffer.reset();
+
     terminateGui();
-    wgpuSwapChainRelease(m_swapChain);
-    wgpuDeviceRelease(m_device);
-    wgpuSurfaceRelease(m_surface);
-    wgpuAdapterRelease(m_adapter);
-    wgpuInstanceRelease(m_instance);
+    m_swapChain.reset();
+    m_queue.reset();
+    m_device.reset();
+    m_surface.reset();
+    m_adapter.reset();
+    m_instance.reset();
+    GpuResourceRegistry::instance().reportLeaks();
 
     glfwDestroyWindow(m_window);
     glfwTerminate();
@@ -423,22 +1498,42 @@ void Application::onFinish()
 
 void Application::onResize()
 {
-    buildSwapchain();
+    int windowWidth, windowHeight;
+    int framebufferWidth, framebufferHeight;
+    glfwGetWindowSize(m_window, &windowWidth, &windowHeight);
+    glfwGetFramebufferSize(m_window, &framebufferWidth, &framebufferHeight);
+    if (m_recorder) {
+        m_recorder->resize(framebufferWidth, framebufferHeight, windowWidth, windowHeight);
+    }
+    handleResize(framebufferWidth, framebufferHeight, windowWidth, windowHeight);
 }
 
-void Application::buildSwapchain()
+void Application::handleResize(int framebufferWidth, int framebufferHeight, int windowWidth, int windowHeight)
 {
-    std::cout << "Buildig swap chain" << std::endl;
+    InputEvent event;
+    event.type = InputEvent::Type::Resize;
+    event.time = glfwGetTime();
+    event.a = framebufferWidth;
+    event.b = framebufferHeight;
+    event.x = windowWidth;
+    event.y = windowHeight;
+    pushInputEvent(event);
+}
 
-    int width, height;
-    glfwGetFramebufferSize(m_window, &width, &height);
+void Application::onRefresh()
+{
+    InputEvent event;
+    event.type = InputEvent::Type::Refresh;
+    event.time = glfwGetTime();
+    pushInputEvent(event);
+}
 
+void Application::buildSwapchain(int width, int height)
+{
     m_uniforms.windowWidth = width;
     m_uniforms.windowHeight = height;
 
-    if (m_swapChain != nullptr) {
-        wgpuSwapChainRelease(m_swapChain);
-    }
+    m_swapChain.reset();
 
 
     WGPUSwapChainDescriptor swapChainDesc{};
@@ -449,36 +1544,55 @@ void Application::buildSwapchain()
     m_swapChainFormat = WGPUTextureFormat_BGRA8Unorm;
     swapChainDesc.format = m_swapChainFormat;
     swapChainDesc.usage = WGPUTextureUsage_RenderAttachment;
-    swapChainDesc.presentMode = WGPUPresentMode_Immediate;
-    m_swapChain = wgpuDeviceCreateSwapChain(m_device, m_surface, &swapChainDesc);
-    std::cout << "Swapchain: " << m_swapChain << std::endl;
-
+    swapChainDesc.presentMode = m_settings.presentMode;
+    m_swapChain = GpuSwapChain(wgpuDeviceCreateSwapChain(m_device, m_surface, &swapChainDesc), resourceCategory);
     if(!m_swapChain) {
         throw std::runtime_error("Failed to create swapChain!");
     }
+    Log::debug() << "Swap chain " << width << "x" << height << ": " << m_swapChain.get();
+
+    if (m_resizeManager) {
+        m_resizeManager->resizeScene(width, height);
+    }
+
+    if (m_histogram) {
+        m_histogram->resize(width, height);
+    }
+    if (m_persistentKernel) {
+        m_persistentKernel->resize(width, height);
+    }
 }
 
 bool Application::initGui()
 {
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
-    auto io = ImGui::GetIO();
-    ImGui_ImplGlfw_InitForOther(m_window, true);
+    ImGuiIO& io = ImGui::GetIO();
+    // Input is forwarded from the event thread by applyInputEvent() rather
+    // than through the GLFW backend, which must run on the window's thread
+    io.ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange;
     ImGui_ImplWGPU_Init(m_device, 3, m_swapChainFormat);
     ImGui::GetStyle().ScaleAllSizes(m_monitorScale);
     // set font size
     io.Fonts->Clear();
-    io.Fonts->AddFontFromFileTTF("assets/fonts/Roboto-Regular.ttf", 16.0f * m_monitorScale);
+    const std::optional<std::string_view> font = Resources::find("assets/fonts/Roboto-Regular.ttf");
+    if (!font) {
+        return false;
+    }
+    // The atlas must not free the embedded data
+    ImFontConfig fontConfig;
+    fontConfig.FontDataOwnedByAtlas = false;
+    io.Fonts->AddFontFromMemoryTTF(const_cast<char *>(font->data()), static_cast<int>(font->size()),
+                                   16.0f * m_monitorScale, &fontConfig);
     return true;
 }
 
 void Application::terminateGui()
 {
     ImGui_ImplWGPU_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
 }
 
-void Application::updateGui(WGPURenderPassEncoder pass)
+void Application::updateGui(WGPURenderPassEncoder pass, float deltaTime)
 {
     // Calculate average frame rate of last 10 frames
     float frameRate = [&](){
@@ -490,17 +1604,132 @@ void Application::updateGui(WGPURenderPassEncoder pass)
     }();
 
 
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(static_cast<float>(m_windowSize[0]), static_cast<float>(m_windowSize[1]));
+    if (m_windowSize[0] > 0 && m_windowSize[1] > 0) {
+        io.DisplayFramebufferScale = ImVec2(static_cast<float>(m_uniforms.windowWidth) / m_windowSize[0],
+                                            static_cast<float>(m_uniforms.windowHeight) / m_windowSize[1]);
+    }
+    io.DeltaTime = deltaTime > 0.0F ? deltaTime : 1.0F / 60.0F;
+
     ImGui_ImplWGPU_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
     ImGui::SetNextWindowSize({800, 200}, ImGuiCond_FirstUseEver);
     ImGui::Begin("WebGPU!");
     ImGui::Text("Average frame rate (%.1f FPS)", frameRate);
+    ImGui::Text("Device: %s", m_capabilities.describe().c_str());
+
+    FramePacer::LatencyStats latency = m_framePacer->inputLatency();
+    ImGui::Text("Input latency: %.1f ms (avg %.1f ms, p95 %.1f ms)",
+                latency.lastMs, latency.averageMs, latency.p95Ms);
+    ImGui::Text("GPU time per frame: %.2f ms", m_framePacer->averageGpuTimeMs());
+    int framesInFlight = static_cast<int>(m_framePacer->maxFramesInFlight());
+    if (ImGui::SliderInt("Frames in flight", &framesInFlight, 1, 4)) {
+        changeSetting(Setting::FramesInFlight, framesInFlight);
+    }
+
     int32_t max_iter = static_cast<int>(m_uniforms.max_iter);
-    ImGui::SliderInt("Max iteration count", &max_iter, 10, 1000);
-    m_uniforms.max_iter = static_cast<float>(max_iter);
+    if (ImGui::SliderInt("Max iteration count", &max_iter, 10, 1000)) {
+        changeSetting(Setting::MaxIterations, max_iter);
+    }
+    bool adaptiveBudget = m_uniforms.adaptiveBudget != 0.0F;
+    if (ImGui::Checkbox("Adaptive per-tile iteration budget", &adaptiveBudget)) {
+        changeSetting(Setting::AdaptiveBudget, adaptiveBudget ? 1.0 : 0.0);
+    }
+    if (adaptiveBudget) {
+        // Same scaling as pixel_budget() in the shaders
+        const IterationBudget::Stats& budget = m_iterationBudget->stats();
+        const double maxBudget = m_uniforms.max_iter +
+            std::max(static_cast<double>(budget.maxDemand) - m_uniforms.max_iter, 0.0) * budget.boostScale();
+        ImGui::Text("Boundary tiles: %u, up to %.0f iterations per pixel (%.0f%% of the requested boost)",
+                    budget.boundaryTiles, maxBudget, 100.0 * budget.boostScale());
+    }
+
+    constexpr std::array<const char *, 4> renderModes = {
+        "Escape time", "Escape time (persistent compute)", "Histogram equalized", "Buddhabrot"
+    };
+    int renderMode = static_cast<int>(m_renderMode);
+    if (ImGui::Combo("Mode", &renderMode, renderModes.data(), static_cast<int>(renderModes.size()))) {
+        changeSetting(Setting::RenderMode, renderMode);
+    }
+    bool showJuliaPanes = m_showJuliaPanes;
+    if (ImGui::Checkbox("Julia previews (right click pins)", &showJuliaPanes)) {
+        changeSetting(Setting::JuliaPanes, showJuliaPanes ? 1.0 : 0.0);
+    }
+    if (m_renderMode == RenderMode::EscapeTimeCompute) {
+        int workgroups = static_cast<int>(m_persistentKernel->workgroupCount());
+        if (ImGui::SliderInt("Persistent workgroups", &workgroups, 1, 1024)) {
+            changeSetting(Setting::PersistentWorkgroups, workgroups);
+        }
+        if (m_precision.tier() != PrecisionManager::Tier::F32) {
+            ImGui::Text("The compute kernel is f32 only, %s precision is drawn by the fragment kernel",
+                        PrecisionManager::tierName(m_precision.tier()));
+        }
+    }
+    if (m_renderMode == RenderMode::Buddhabrot) {
+        ImGui::Text("Orbit samples: %.3g (%.1f Msamples/s)%s",
+                    static_cast<double>(m_buddhabrot->totalSamples()),
+                    m_buddhabrot->samplesPerSecond() * 1e-6,
+                    m_buddhabrot->isAccumulating() ? "" : ", done");
+        float gamma = m_buddhabrot->gamma();
+        if (ImGui::SliderFloat("Gamma", &gamma, 0.1F, 2.0F, "%.2f")) {
+            changeSetting(Setting::BuddhabrotGamma, gamma);
+        }
+    }
+
+    ImGui::Text("Zoom %.3g, precision: %s", m_renderView.scale,
+                PrecisionManager::tierName(m_precision.tier()));
+    constexpr std::array<const char *, 4> precisionModes = { "Automatic", "f16", "f32", "Extended (df64)" };
+    const std::optional<PrecisionManager::Tier> forcedTier = m_precision.forcedTier();
+    int precisionMode = forcedTier ? static_cast<int>(*forcedTier) + 1 : 0;
+    if (ImGui::Combo("Precision", &precisionMode, precisionModes.data(), static_cast<int>(precisionModes.size()))) {
+        changeSetting(Setting::PrecisionMode, precisionMode);
+    }
+    if (m_precision.isSupported(PrecisionManager::Tier::F16)) {
+        ImGui::Text("Automatic only uses f16 up to %.0f iterations, longer f16 orbits drift from f32",
+                    PrecisionManager::maxF16Iterations);
+    }
+    float safetyFactor = m_precision.safetyFactor();
+    if (ImGui::SliderFloat("Precision safety factor", &safetyFactor, 1.0F, 64.0F, "%.1f")) {
+        changeSetting(Setting::PrecisionSafetyFactor, safetyFactor);
+    }
+
+    GpuResourceRegistry& resources = GpuResourceRegistry::instance();
+    constexpr double mebibyte = 1024.0 * 1024.0;
+    if (ImGui::CollapsingHeader("GPU resources")) {
+        ImGui::Text("%llu objects, %.1f MiB (estimated)", static_cast<unsigned long long>(resources.liveObjects()),
+                    resources.totalBytes() / mebibyte);
+        ImGui::Text("Render targets: %llu allocated, %llu reused",
+                    static_cast<unsigned long long>(m_renderTargets->allocationCount()),
+                    static_cast<unsigned long long>(m_renderTargets->reuseCount()));
+        if (ImGui::BeginTable("GPU resources", 4)) {
+            ImGui::TableSetupColumn("Owner");
+            ImGui::TableSetupColumn("Objects");
+            ImGui::TableSetupColumn("Buffers (MiB)");
+            ImGui::TableSetupColumn("Textures (MiB)");
+            ImGui::TableHeadersRow();
+            for (const GpuResourceRegistry::CategoryUsage& usage : resources.usage()) {
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(usage.category.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", usage.objects);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", usage.bufferBytes / mebibyte);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", usage.textureBytes / mebibyte);
+            }
+            ImGui::EndTable();
+        }
+    }
     ImGui::End();
 
+    // Keep drawing while a widget is being dragged, even if the mouse is still
+    if (ImGui::IsAnyItemActive()) {
+        markDirty(DirtyGui);
+    }
+
+
+    m_guiWantsMouse.store(io.WantCaptureMouse, std::memory_order_relaxed);
 
     ImGui::EndFrame();
     ImGui::Render();
@@ -508,39 +1737,123 @@ void Application::updateGui(WGPURenderPassEncoder pass)
 }
 
 void Application::onMouseMove(double x, double y) {
-//    std::cout << "Mouse moved to (" << x << ", " << y << ")" << std::endl;
+    if (m_recorder) {
+        m_recorder->mouseMove(x, y);
+    }
     if(m_mouseState == MouseState::Dragging){
         double diffX = x - m_previousMouseX;
         double diffY = y - m_previousMouseY;
-        m_uniforms.offset[0] += static_cast<float>(diffX);
-        m_uniforms.offset[1] += static_cast<float>(diffY);
+        m_view.offset[0] += diffX;
+        m_view.offset[1] += diffY;
         m_previousMouseX = x;
         m_previousMouseY = y;
+        publishView();
     }
+
+    // Pushed after the view is published, so the frame that first sees this
+    // event (and takes its timestamp) also sees its effect on the view
+    InputEvent event;
+    event.type = InputEvent::Type::MouseMove;
+    event.time = glfwGetTime();
+    event.x = x;
+    event.y = y;
+    pushInputEvent(event);
 }
 
 void Application::onScroll(double x, double y)
 {
-    constexpr float minScale = 0.1F;
-    constexpr float maxScale = 100000.0F;
+    // The extended precision kernel resolves pixels down to ~1e-14
+    constexpr double minScale = 0.1;
+    constexpr double maxScale = 1e11;
+
+    if (m_recorder) {
+        m_recorder->scroll(x, y);
+    }
 
-    float desiredScale = m_uniforms.scale + static_cast<float>(y/10.F * m_uniforms.scale);
-    float newScale = std::clamp(desiredScale, minScale, maxScale);
-    m_uniforms.offset[0] = m_uniforms.offset[0] * newScale / m_uniforms.scale;
-    m_uniforms.offset[1] = m_uniforms.offset[1] * newScale / m_uniforms.scale;
-    m_uniforms.scale = newScale;
+    double desiredScale = m_view.scale + y / 10.0 * m_view.scale;
+    double newScale = std::clamp(desiredScale, minScale, maxScale);
+    m_view.offset[0] = m_view.offset[0] * newScale / m_view.scale;
+    m_view.offset[1] = m_view.offset[1] * newScale / m_view.scale;
+    m_view.scale = newScale;
+    publishView();
+
+    InputEvent event;
+    event.type = InputEvent::Type::Scroll;
+    event.time = glfwGetTime();
+    event.x = x;
+    event.y = y;
+    pushInputEvent(event);
 }
 
 void Application::onMouseButton(int button, int action, int mods) {
-    ImGuiIO& io = ImGui::GetIO();
-    if (io.WantCaptureMouse) {
+    double x, y;
+    glfwGetCursorPos(m_window, &x, &y);
+    const bool guiCaptured = m_guiWantsMouse.load(std::memory_order_relaxed);
+    if (m_recorder) {
+        m_recorder->mouseButton(button, action, mods, x, y, guiCaptured);
+    }
+    handleMouseButton(button, action, mods, x, y, guiCaptured);
+}
+
+void Application::handleMouseButton(int button, int action, int mods, double x, double y, bool guiCaptured)
+{
+    InputEvent event;
+    event.type = InputEvent::Type::MouseButton;
+    event.time = glfwGetTime();
+    event.a = button;
+    event.b = action;
+    event.c = mods;
+    pushInputEvent(event);
+
+    if (guiCaptured) {
         return;
     }
     if(button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
         m_mouseState = MouseState::Dragging;
-        glfwGetCursorPos(m_window, &m_previousMouseX, &m_previousMouseY);
+        m_previousMouseX = x;
+        m_previousMouseY = y;
     }
     else {
         m_mouseState = MouseState::Idle;
     }
 }
+
+void Application::onKey(int key, int action, int mods)
+{
+    InputEvent event;
+    event.type = InputEvent::Type::Key;
+    event.time = glfwGetTime();
+    event.a = key;
+    event.b = action;
+    event.c = mods;
+    pushInputEvent(event);
+}
+
+void Application::onChar(unsigned int codepoint)
+{
+    InputEvent event;
+    event.type = InputEvent::Type::Char;
+    event.time = glfwGetTime();
+    event.a = static_cast<int32_t>(codepoint);
+    pushInputEvent(event);
+}
+
+void Application::onFocus(bool focused)
+{
+    InputEvent event;
+    event.type = InputEvent::Type::Focus;
+    event.time = glfwGetTime();
+    event.a = focused ? 1 : 0;
+    pushInputEvent(event);
+}
+
+void Application::onCursorEnter(bool entered)
+{
+    if (entered) {
+        return;
+    }
+    InputEvent event;
+    event.type = InputEvent::Type::CursorLeave;
+    event.time = glfwGetTime();
+    pushInputEvent(event);
+}
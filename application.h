@@ -1,6 +1,31 @@
+#pragma once
+
+#include "devicecapabilities.h"
+#include "buddhabrot.h"
+#include "framepacer.h"
+#include "gpuresource.h"
+#include "gputimer.h"
+#include "histogramcoloring.h"
+#include "inputtrace.h"
+#include "iterationbudget.h"
+#include "persistentkernel.h"
+#include "precisionmanager.h"
+#include "rendertargetpool.h"
+#include "resizemanager.h"
+#include "spscqueue.h"
+#include "triplebuffer.h"
+#include "uniformring.h"
+
 #include <webgpu/webgpu.h>
 
 #include <array>
+#include <atomic>
+#include <cstddef>
+#include <ctime>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 struct GLFWwindow;
@@ -8,28 +33,157 @@ struct GLFWwindow;
 class Application
 {
 public:
-    Application();
+    struct Settings {
+        WGPUPresentMode presentMode = WGPUPresentMode_Fifo;
+        // Render every iteration of the main loop, like a game loop would
+        bool continuous = false;
+        // Encode and present on a dedicated thread instead of the event thread
+        bool renderThread = true;
+        // Upper bound on how long waitEvents() blocks when nothing is dirty
+        double idleTimeout = 1.0;
+        // How many frames the CPU may submit before waiting for the GPU
+        uint32_t maxFramesInFlight = 2;
+        // Highest optional feature tier to request from the adapter
+        DeviceCapabilities::Tier maxFeatureTier = DeviceCapabilities::Tier::Fast;
+        // Run the named benchmark instead of the interactive loop
+        std::string benchmark;
+        // Write the window input and overlay changes to this trace file
+        std::string recordPath;
+        // Replay this trace headless instead of the interactive loop
+        std::string replayPath;
+        // Fixed frame clock of the replay
+        double replayFrameRate = 60.0;
+        // Load shaders and fonts from this directory when it has them,
+        // instead of the copies embedded in the binary
+        std::string resourceDirectory;
+
+        InputTrace::LaunchSettings launchSettings() const;
+        // Takes over the settings of a recorded run
+        void applyLaunchSettings(const InputTrace::LaunchSettings& launch);
+    };
+
+    explicit Application(const Settings& settings);
 
     enum class MouseState { Idle, Dragging };
 
+    enum class RenderMode { EscapeTime, EscapeTimeCompute, Histogram, Buddhabrot };
+
+    // Reasons for which a new frame has to be rendered
+    enum DirtyFlag : uint32_t {
+        DirtyNone = 0,
+        DirtyUniforms = 1 << 0,
+        DirtyResize = 1 << 1,
+        DirtyGui = 1 << 2,
+        DirtyProgressive = 1 << 3,
+    };
+
     bool isRunning() const;
 
+    // Polls events when a frame is due, otherwise blocks until an event arrives.
+    // With a render thread this only pumps the GLFW event queue.
+    void waitEvents();
+
+    bool needsRedraw() const;
+
+    void startRenderThread();
+
+    // Joins the render thread and rethrows any exception it terminated with
+    void stopRenderThread();
+
     void onFrame();
 
+    // Renders synchronously on the calling thread and prints a report
+    void runBenchmark(const std::string& name);
+
+    // Renders the recorded input frame by frame on the calling thread, on a
+    // fixed clock, and writes a per-frame timing report next to the trace.
+    // The settings should have been taken from the trace with
+    // applyLaunchSettings() before the application was created.
+    void runReplay(const InputTrace& trace, const std::string& path);
+
     void onFinish();
 
+    // Input callbacks, called on the thread that owns the window
     void onResize();
 
+    void onRefresh();
+
     void onMouseMove(double x, double y);
 
     void onScroll(double x, double y);
 
     void onMouseButton(int button, int action, int mods);
+
+    void onKey(int key, int action, int mods);
+
+    void onChar(unsigned int codepoint);
+
+    void onFocus(bool focused);
+
+    void onCursorEnter(bool entered);
 private:
-    void buildSwapchain();
+    // Raw window events forwarded from the event thread to the render thread
+    struct InputEvent {
+        enum class Type : uint8_t {
+            MouseMove, MouseButton, Scroll, Key, Char, Focus, CursorLeave, Resize, Refresh
+        };
+        Type type = Type::MouseMove;
+        double time = 0.0;
+        // Cursor position, scroll offsets or window size depending on type
+        double x = 0.0;
+        double y = 0.0;
+        // Button/key/codepoint, action and mods, or framebuffer size
+        int32_t a = 0;
+        int32_t b = 0;
+        int32_t c = 0;
+    };
+
+    // Overlay controls, recorded and replayed by id
+    enum class Setting : uint8_t {
+        FramesInFlight, MaxIterations, AdaptiveBudget, RenderMode, JuliaPanes,
+        PersistentWorkgroups, BuddhabrotGamma, PrecisionMode, PrecisionSafetyFactor
+    };
+
+    // View parameters owned by the event thread and published to the renderer
+    struct ViewState {
+        // Kept in double so that deep zooms do not lose the pan position
+        std::array<double, 2> offset = { 0.0, 0.0 };
+        double scale = 1.0;
+    };
+
+    void markDirty(uint32_t flags);
+    void pushInputEvent(const InputEvent& event);
+    void wakeRenderThread();
+    void renderLoop();
+    void processInputEvents();
+    void applyInputEvent(const InputEvent& event);
+    void publishView();
+    // The window callbacks past the state they read from GLFW, shared with the replay
+    void handleMouseButton(int button, int action, int mods, double x, double y, bool guiCaptured);
+    void handleResize(int framebufferWidth, int framebufferHeight, int windowWidth, int windowHeight);
+    void changeSetting(Setting setting, double value);
+    void applySetting(Setting setting, double value);
+    void replayEvent(const InputTrace::Event& event);
+    void updateViewUniforms();
+    // glfwGetTime(), or the frame clock of a running replay
+    double currentTime() const;
+    // Renders the fractal and the Julia panes into the scene target
+    void encodeScene(WGPUCommandEncoder encoder);
+    ViewState viewCenteredAt(double x, double y, double scale) const;
+    double measureGpuFrameTime();
+    // Escape times of one histogram frame, row by row
+    std::vector<float> readIterationCounts();
+    void runPrecisionBenchmark();
+    void runDivergenceBenchmark();
+    void runBudgetBenchmark();
+    void drawFractal(WGPURenderPassEncoder pass, WGPURenderPipeline pipeline);
+    void drawJuliaPanes(WGPURenderPassEncoder pass);
+    // Complex coordinate under a point given in window coordinates
+    std::array<double, 2> complexAt(double windowX, double windowY) const;
+    void buildSwapchain(int width, int height);
     bool initGui();
     void terminateGui();
-    void updateGui(WGPURenderPassEncoder pass);
+    void updateGui(WGPURenderPassEncoder pass, float deltaTime);
 
     struct Uniform {
         std::array<float, 2> offset = { 0.0F, 0.0F };
@@ -37,32 +191,104 @@ private:
         int32_t windowWidth = 800;
         int32_t windowHeight = 600;
         float max_iter = 512.0;
+        // Julia set parameter, only read by the f32 kernel when julia != 0
+        std::array<float, 2> juliaC = { 0.0F, 0.0F };
+        // Double-float (hi, lo) pairs: origin is the complex coordinate of
+        // pixel (0, 0) as (x_hi, x_lo, y_hi, y_lo), pixelStep the distance
+        // between two pixels
+        std::array<float, 4> origin = { 0.0F, 0.0F, 0.0F, 0.0F };
+        std::array<float, 2> pixelStep = { 0.0F, 0.0F };
+        float julia = 0.0F;
+        // Non-zero to use the per-tile budgets of IterationBudget
+        float adaptiveBudget = 0.0F;
     };
-    static_assert(sizeof(Uniform) % sizeof(std::array<float, 2>) == 0);
+    // Must match the WGSL layout, where vec4f origin is 16-byte aligned
+    static_assert(offsetof(Uniform, origin) == 32);
+    static_assert(sizeof(Uniform) == 64);
+
+    Settings m_settings;
 
+    // Render thread state
     Uniform m_uniforms;
-    WGPUInstance m_instance = nullptr;
-    WGPUAdapter m_adapter = nullptr;
-    WGPUDevice m_device = nullptr;
-    WGPUSurface m_surface = nullptr;
-    WGPUQueue m_queue = nullptr;
-    WGPURenderPipeline m_renderPipeline;
-    WGPUSwapChain m_swapChain = nullptr;
+    uint32_t m_dirtyFlags = DirtyUniforms;
+    int m_guiFramesPending = 0;
+    GpuInstance m_instance;
+    GpuAdapter m_adapter;
+    GpuDevice m_device;
+    DeviceCapabilities m_capabilities;
+    GpuSurface m_surface;
+    GpuQueue m_queue;
+    PrecisionManager m_precision{ false };
+    ViewState m_renderView;
+    std::array<GpuRenderPipeline, PrecisionManager::tierCount> m_renderPipelines;
+    std::array<GpuRenderPipeline, PrecisionManager::tierCount> m_iterationPipelines;
+    RenderMode m_renderMode = RenderMode::EscapeTime;
+    std::unique_ptr<RenderTargetPool> m_renderTargets;
+    std::unique_ptr<ResizeManager> m_resizeManager;
+    std::unique_ptr<HistogramColoring> m_histogram;
+    std::unique_ptr<Buddhabrot> m_buddhabrot;
+    std::unique_ptr<PersistentKernel> m_persistentKernel;
+    std::unique_ptr<IterationBudget> m_iterationBudget;
+    // Only with timestamp queries; brackets the scene passes while
+    // m_timeScene is set by the benchmarks
+    std::unique_ptr<GpuTimer> m_sceneTimer;
+    bool m_timeScene = false;
+
+    // Julia previews drawn over the main view with the f32 kernel. Their
+    // uniforms come from one ring buffer bound with dynamic offsets.
+    static constexpr size_t juliaPaneCount = 4;
+    bool m_showJuliaPanes = false;
+    // The first pane follows the cursor, right clicks pin the others
+    std::array<std::array<double, 2>, juliaPaneCount> m_juliaPoints{};
+    size_t m_pinnedJuliaPanes = 0;
+    size_t m_nextPinnedPane = 1;
+    std::array<double, 2> m_cursorPosition = { -1.0, -1.0 };
+    std::unique_ptr<UniformRing> m_uniformRing;
+    GpuRenderPipeline m_juliaPipeline;
+    GpuBindGroup m_juliaBindGroup;
+    GpuSwapChain m_swapChain;
     WGPUTextureFormat m_swapChainFormat = WGPUTextureFormat_Undefined;
-    WGPUBuffer m_indexBuffer = nullptr;
-    WGPUBuffer m_vertexBuffer = nullptr;
-    WGPUBuffer m_uniformBuffer = nullptr;
-    WGPUBindGroup m_bindGroup = nullptr;
-    WGPUShaderModule m_shaderModule = nullptr;
+    GpuBuffer m_indexBuffer;
+    GpuBuffer m_vertexBuffer;
+    GpuBuffer m_uniformBuffer;
+    GpuBindGroup m_bindGroup;
+    std::array<GpuShaderModule, PrecisionManager::tierCount> m_shaderModules;
     GLFWwindow *m_window = nullptr;
     int m_vertexCount = 0;
     int m_indexCount = 0;
+    std::array<int, 2> m_windowSize = { 800, 600 };
+    std::unique_ptr<FramePacer> m_framePacer;
+    // Timestamp of the oldest input event not yet part of a submitted frame
+    double m_frameInputTime = -1.0;
 
     std::vector<float> m_frameTimesList;
     double m_previousFrameTime = 0.0;
+    double m_startTime = 0.0;
+    std::clock_t m_startCpuTime = 0;
+    uint64_t m_renderedFrames = 0;
+    uint64_t m_idleWaits = 0;
+    // Frame clock of a running replay, which ignores the overlay's own changes
+    bool m_replaying = false;
+    double m_replayTime = 0.0;
+
+    // Event thread state
+    ViewState m_view;
     MouseState m_mouseState = MouseState::Idle;
     double m_previousMouseX = 0.0;
     double m_previousMouseY = 0.0;
+    uint64_t m_droppedInputEvents = 0;
 
     float m_monitorScale = 1.0F;
+
+    // Shared between the two threads
+    SpscQueue<InputEvent, 4096> m_inputQueue;
+    TripleBuffer<ViewState> m_viewSnapshots;
+    std::atomic<bool> m_guiWantsMouse = false;
+    std::atomic<uint32_t> m_wakeCounter = 0;
+    std::atomic<bool> m_renderThreadRunning = false;
+    std::thread m_renderThread;
+    std::exception_ptr m_renderThreadError;
+    std::unique_ptr<InputRecorder> m_recorder;
+    // Raised by the uncaptured error callback, whichever thread ticks the device
+    std::atomic<uint32_t> m_deviceErrors = 0;
 };
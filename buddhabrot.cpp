@@ -0,0 +1,188 @@
+#include "buddhabrot.h"
+#include "utils.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+
+namespace {
+// Must match the constants in buddhabrot.wgsl
+constexpr uint32_t tileWidth = 64;
+constexpr uint32_t tileHeight = 32;
+constexpr uint32_t accumulateWorkgroupSize = 64;
+constexpr uint32_t reduceItemsPerWorkgroup = 256 * 4;
+
+// The whole set, centered, fitted to the shorter side of the window
+constexpr std::array<double, 2> viewCenter = { -0.5, 0.0 };
+constexpr double viewExtent = 3.2;
+
+constexpr double rateWindowSeconds = 1.0;
+
+constexpr const char *resourceCategory = "Buddhabrot";
+} // namespace
+
+Buddhabrot::Buddhabrot(WGPUDevice device, WGPUQueue queue, WGPUTextureFormat targetFormat)
+    : m_device(device)
+    , m_queue(queue)
+{
+    m_shaderModule = GpuShaderModule(Utils::loadShaderModule("shaders/buddhabrot.wgsl", m_device), resourceCategory);
+    if (!m_shaderModule) {
+        throw std::runtime_error("Failed to load the Buddhabrot shaders!");
+    }
+
+    m_accumulatePipeline = GpuComputePipeline(
+        Utils::createComputePipeline(m_device, m_shaderModule, "cs_accumulate"), resourceCategory);
+    m_maxPipeline = GpuComputePipeline(Utils::createComputePipeline(m_device, m_shaderModule, "cs_max"), resourceCategory);
+    m_tonemapPipeline = GpuRenderPipeline(
+        Utils::createFullscreenPipeline(m_device, m_shaderModule, "fs_tonemap", targetFormat), resourceCategory);
+
+    WGPUBufferDescriptor bufferDesc{};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.mappedAtCreation = false;
+    bufferDesc.label = "Buddhabrot parameters";
+    bufferDesc.size = sizeof(Params);
+    bufferDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
+    m_paramsBuffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+    bufferDesc.label = "Buddhabrot maximum density";
+    bufferDesc.size = sizeof(uint32_t);
+    bufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+    m_maxBuffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+}
+
+void Buddhabrot::releaseSizedResources()
+{
+    m_tonemapBindGroup.reset();
+    m_maxBindGroup.reset();
+    m_accumulateBindGroup.reset();
+    m_densityBuffer.reset();
+}
+
+void Buddhabrot::configure(uint32_t width, uint32_t height, uint32_t maxIterations)
+{
+    const bool resized = width != m_params.size[0] || height != m_params.size[1];
+    if (!resized && maxIterations == m_params.maxIterations && m_densityBuffer != nullptr) {
+        return;
+    }
+    m_params.maxIterations = maxIterations;
+    reset();
+    if (!resized && m_densityBuffer != nullptr) {
+        return;
+    }
+
+    releaseSizedResources();
+    m_params.size = { width, height };
+    if (width == 0 || height == 0) {
+        return;
+    }
+    const double pixelStep = viewExtent / std::min(width, height);
+    m_params.pixelStep = static_cast<float>(pixelStep);
+    m_params.origin = { static_cast<float>(viewCenter[0] - 0.5 * width * pixelStep),
+                        static_cast<float>(viewCenter[1] - 0.5 * height * pixelStep) };
+
+    WGPUBufferDescriptor bufferDesc{};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.mappedAtCreation = false;
+    bufferDesc.label = "Buddhabrot density";
+    bufferDesc.size = uint64_t(width) * height * sizeof(uint32_t);
+    bufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+    m_densityBuffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+
+    const std::array entries = {
+        Utils::bufferBindGroupEntry(0, m_paramsBuffer, sizeof(Params)),
+        Utils::bufferBindGroupEntry(1, m_densityBuffer, bufferDesc.size),
+        Utils::bufferBindGroupEntry(2, m_maxBuffer, sizeof(uint32_t)),
+    };
+    // The accumulation does not touch the maximum, and automatic layouts only
+    // contain the bindings an entry point uses
+    m_accumulateBindGroup = GpuBindGroup(Utils::createBindGroup(m_device, wgpuComputePipelineGetBindGroupLayout(m_accumulatePipeline, 0),
+                                                                std::span(entries).first(2)), resourceCategory);
+    m_maxBindGroup = GpuBindGroup(Utils::createBindGroup(m_device, wgpuComputePipelineGetBindGroupLayout(m_maxPipeline, 0), entries),
+                                  resourceCategory);
+    m_tonemapBindGroup = GpuBindGroup(Utils::createBindGroup(m_device, wgpuRenderPipelineGetBindGroupLayout(m_tonemapPipeline, 0), entries),
+                                      resourceCategory);
+}
+
+void Buddhabrot::reset()
+{
+    m_clearPending = true;
+    m_totalSamples = 0;
+    m_rateWindowStart = glfwGetTime();
+    m_rateWindowSamples = 0;
+}
+
+void Buddhabrot::setGamma(float gamma)
+{
+    m_params.gamma = gamma;
+}
+
+std::array<uint32_t, 2> Buddhabrot::tileCount() const
+{
+    return { (m_params.size[0] + tileWidth - 1) / tileWidth,
+             (m_params.size[1] + tileHeight - 1) / tileHeight };
+}
+
+uint64_t Buddhabrot::samplesPerFrame() const
+{
+    const std::array<uint32_t, 2> tiles = tileCount();
+    return uint64_t(tiles[0]) * tiles[1] * accumulateWorkgroupSize * m_params.samplesPerThread;
+}
+
+void Buddhabrot::encode(WGPUCommandEncoder encoder)
+{
+    if (m_densityBuffer == nullptr) {
+        return;
+    }
+    // Uploaded even when the accumulation is done, the tone map reads it too
+    wgpuQueueWriteBuffer(m_queue, m_paramsBuffer, 0, &m_params, sizeof(Params));
+    if (!isAccumulating()) {
+        return;
+    }
+
+    const uint64_t pixelCount = uint64_t(m_params.size[0]) * m_params.size[1];
+    if (m_clearPending) {
+        wgpuCommandEncoderClearBuffer(encoder, m_densityBuffer, 0, pixelCount * sizeof(uint32_t));
+        m_clearPending = false;
+    }
+    wgpuCommandEncoderClearBuffer(encoder, m_maxBuffer, 0, sizeof(uint32_t));
+
+    WGPUComputePassDescriptor computePassDesc{};
+    computePassDesc.nextInChain = nullptr;
+    computePassDesc.label = "Buddhabrot";
+    computePassDesc.timestampWrites = nullptr;
+    WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(encoder, &computePassDesc);
+
+    const std::array<uint32_t, 2> tiles = tileCount();
+    wgpuComputePassEncoderSetPipeline(pass, m_accumulatePipeline);
+    wgpuComputePassEncoderSetBindGroup(pass, 0, m_accumulateBindGroup, 0, nullptr);
+    wgpuComputePassEncoderDispatchWorkgroups(pass, tiles[0], tiles[1], 1);
+
+    wgpuComputePassEncoderSetPipeline(pass, m_maxPipeline);
+    wgpuComputePassEncoderSetBindGroup(pass, 0, m_maxBindGroup, 0, nullptr);
+    wgpuComputePassEncoderDispatchWorkgroups(pass,
+        static_cast<uint32_t>((pixelCount + reduceItemsPerWorkgroup - 1) / reduceItemsPerWorkgroup), 1, 1);
+
+    wgpuComputePassEncoderEnd(pass);
+    wgpuComputePassEncoderRelease(pass);
+
+    ++m_params.frame;
+    m_totalSamples += samplesPerFrame();
+    m_rateWindowSamples += samplesPerFrame();
+    const double now = glfwGetTime();
+    if (now - m_rateWindowStart >= rateWindowSeconds) {
+        m_samplesPerSecond = static_cast<double>(m_rateWindowSamples) / (now - m_rateWindowStart);
+        m_rateWindowStart = now;
+        m_rateWindowSamples = 0;
+    }
+}
+
+void Buddhabrot::draw(WGPURenderPassEncoder pass)
+{
+    if (m_densityBuffer == nullptr) {
+        return;
+    }
+    wgpuRenderPassEncoderSetPipeline(pass, m_tonemapPipeline);
+    wgpuRenderPassEncoderSetBindGroup(pass, 0, m_tonemapBindGroup, 0, nullptr);
+    wgpuRenderPassEncoderDraw(pass, 3, 1, 0, 0);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "gpuresource.h"
+
+#include <webgpu/webgpu.h>
+
+#include <array>
+#include <cstdint>
+
+// Orbit density (Buddhabrot) renderer. Every encode() scatters another batch
+// of random orbits into a per-pixel hit count buffer with atomics; the counts
+// accumulate until the view changes and draw() tone-maps them.
+class Buddhabrot
+{
+public:
+    // Accumulation stops after this many samples, where more samples no
+    // longer visibly reduce the noise. This is only a quality cutoff, not an
+    // overflow bound: one sample can add up to max_iter hits to a pixel.
+    static constexpr uint64_t sampleBudget = uint64_t(1) << 32;
+
+    Buddhabrot(WGPUDevice device, WGPUQueue queue, WGPUTextureFormat targetFormat);
+    Buddhabrot(const Buddhabrot&) = delete;
+    Buddhabrot& operator=(const Buddhabrot&) = delete;
+
+    // Restarts the accumulation when the size or the iteration count changed
+    void configure(uint32_t width, uint32_t height, uint32_t maxIterations);
+
+    void reset();
+
+    bool isAccumulating() const { return m_totalSamples < sampleBudget; }
+
+    // Records one accumulation batch and the tone map normalization
+    void encode(WGPUCommandEncoder encoder);
+
+    // Draws the tone-mapped density into the current render pass
+    void draw(WGPURenderPassEncoder pass);
+
+    uint64_t samplesPerFrame() const;
+    uint64_t totalSamples() const { return m_totalSamples; }
+    // Submitted samples per second over the last measurement window. The
+    // frame pacer keeps the CPU at most a few frames ahead of the GPU, so
+    // this follows the GPU throughput.
+    double samplesPerSecond() const { return m_samplesPerSecond; }
+
+    float gamma() const { return m_params.gamma; }
+    void setGamma(float gamma);
+
+private:
+    struct Params {
+        std::array<float, 2> origin = { 0.0F, 0.0F };
+        std::array<uint32_t, 2> size = { 0, 0 };
+        float pixelStep = 0.0F;
+        uint32_t maxIterations = 512;
+        uint32_t minIterations = 20;
+        uint32_t frame = 0;
+        uint32_t samplesPerThread = 16;
+        float gamma = 0.5F;
+    };
+    // Must match the WGSL layout
+    static_assert(sizeof(Params) == 40);
+
+    void releaseSizedResources();
+    std::array<uint32_t, 2> tileCount() const;
+
+    WGPUDevice m_device = nullptr;
+    WGPUQueue m_queue = nullptr;
+    Params m_params;
+    bool m_clearPending = true;
+    uint64_t m_totalSamples = 0;
+    double m_rateWindowStart = 0.0;
+    uint64_t m_rateWindowSamples = 0;
+    double m_samplesPerSecond = 0.0;
+
+    GpuShaderModule m_shaderModule;
+    GpuComputePipeline m_accumulatePipeline;
+    GpuComputePipeline m_maxPipeline;
+    GpuRenderPipeline m_tonemapPipeline;
+    GpuBuffer m_paramsBuffer;
+    GpuBuffer m_maxBuffer;
+
+    // Recreated on resize
+    GpuBuffer m_densityBuffer;
+    GpuBindGroup m_accumulateBindGroup;
+    GpuBindGroup m_maxBindGroup;
+    GpuBindGroup m_tonemapBindGroup;
+};
@@ -0,0 +1,7 @@
+# Script mode helper of EmbedResources: writes the bytes of INPUT to OUTPUT as
+# a list of hex literals, 16 per line.
+file(READ "${INPUT}" hex HEX)
+string(REPEAT "[0-9a-f]" 32 line)
+string(REGEX REPLACE "(${line})" "\\1\n" hex "${hex}")
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+file(WRITE "${OUTPUT}" "${bytes}\n")
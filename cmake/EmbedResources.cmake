@@ -0,0 +1,42 @@
+#[=======================================================================[.rst:
+EmbedResources
+--------------
+
+Compiles files into a target as constexpr byte arrays, so that the binary
+does not depend on the working directory it is started from.
+
+  embed_resources(<target> <base-dir> <file>...)
+
+Every file, given relative to <base-dir>, is converted at build time into
+``embedded/<identifier>.inc``. The generated ``embeddedresources.inc``
+defines one null terminated array per file and the ``embeddedResources``
+table of ``{ path, bytes }`` entries, for resources.cpp to include.
+#]=======================================================================]
+
+set(EMBED_FILE_SCRIPT "${CMAKE_CURRENT_LIST_DIR}/EmbedFile.cmake")
+
+function(embed_resources TARGET BASE_DIR)
+  set(outputDir "${CMAKE_CURRENT_BINARY_DIR}/embedded")
+  set(arrays "")
+  set(entries "")
+  foreach(resource IN LISTS ARGN)
+    string(MAKE_C_IDENTIFIER "${resource}" identifier)
+    set(input "${BASE_DIR}/${resource}")
+    set(output "${outputDir}/${identifier}.inc")
+    add_custom_command(
+      OUTPUT "${output}"
+      COMMAND ${CMAKE_COMMAND} -DINPUT=${input} -DOUTPUT=${output} -P ${EMBED_FILE_SCRIPT}
+      DEPENDS "${input}" "${EMBED_FILE_SCRIPT}"
+      COMMENT "Embedding ${resource}"
+      VERBATIM)
+    target_sources(${TARGET} PRIVATE "${output}" "${input}")
+    set_source_files_properties("${output}" "${input}" PROPERTIES HEADER_FILE_ONLY ON)
+    string(APPEND arrays "constexpr unsigned char ${identifier}[] = {\n#include \"${identifier}.inc\"\n    0x00\n};\n")
+    string(APPEND entries "    { \"${resource}\", { ${identifier}, sizeof(${identifier}) - 1 } },\n")
+  endforeach()
+
+  # Only rewritten when the list of files changes
+  file(CONFIGURE OUTPUT "${outputDir}/embeddedresources.inc" CONTENT
+    "// Generated by cmake/EmbedResources.cmake\n${arrays}\nconstexpr EmbeddedResource embeddedResources[] = {\n${entries}};\n")
+  target_include_directories(${TARGET} PRIVATE "${outputDir}")
+endfunction()
@@ -0,0 +1,124 @@
+#include "devicecapabilities.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+bool hasFeature(const std::vector<WGPUFeatureName>& features, WGPUFeatureName feature)
+{
+    return std::find(features.begin(), features.end(), feature) != features.end();
+}
+
+WGPULimits defaultLimits()
+{
+    // Every "undefined" sentinel (WGPU_LIMIT_U32_UNDEFINED and
+    // WGPU_LIMIT_U64_UNDEFINED) is all ones, which asks for the default
+    WGPULimits limits;
+    std::memset(&limits, 0xFF, sizeof(limits));
+    return limits;
+}
+} // namespace
+
+DeviceCapabilities DeviceCapabilities::fromAdapter(WGPUAdapter adapter, Tier maxTier)
+{
+    std::vector<WGPUFeatureName> features;
+    features.resize(wgpuAdapterEnumerateFeatures(adapter, nullptr));
+    wgpuAdapterEnumerateFeatures(adapter, features.data());
+
+    WGPUSupportedLimits supportedLimits{};
+    wgpuAdapterGetLimits(adapter, &supportedLimits);
+
+    DeviceCapabilities caps;
+    caps.m_requiredLimits.limits = defaultLimits();
+
+    if (maxTier >= Tier::HighLimits) {
+        caps.m_tier = Tier::HighLimits;
+        // Asking for the adapter's own limits never fails and lifts the
+        // default 128 MiB storage binding and 256 MiB buffer caps
+        caps.m_requiredLimits.limits = supportedLimits.limits;
+        caps.m_largeStorageBuffers =
+            supportedLimits.limits.maxStorageBufferBindingSize >= largeStorageBufferSize;
+        caps.m_timestampQuery = hasFeature(features, WGPUFeatureName_TimestampQuery);
+    }
+    if (maxTier >= Tier::Fast && hasFeature(features, WGPUFeatureName_ShaderF16)) {
+        caps.m_tier = Tier::Fast;
+        caps.m_shaderF16 = true;
+    }
+
+    if (caps.m_timestampQuery) {
+        caps.m_requiredFeatures.push_back(WGPUFeatureName_TimestampQuery);
+    }
+    if (caps.m_shaderF16) {
+        caps.m_requiredFeatures.push_back(WGPUFeatureName_ShaderF16);
+    }
+    // The Dawn version used here still gates timestamp queries (used by the
+    // benchmarks) and shader-f16 behind its "unsafe APIs" toggle
+    if (!caps.m_requiredFeatures.empty()) {
+        caps.m_enabledToggles.push_back("allow_unsafe_apis");
+    }
+
+    caps.m_limits = caps.m_requiredLimits.limits;
+    return caps;
+}
+
+void DeviceCapabilities::configureDeviceDescriptor(WGPUDeviceDescriptor& descriptor)
+{
+    descriptor.requiredFeatureCount = m_requiredFeatures.size();
+    descriptor.requiredFeatures = m_requiredFeatures.data();
+    descriptor.requiredLimits = &m_requiredLimits;
+
+    if (!m_enabledToggles.empty()) {
+        m_toggles = {};
+        m_toggles.chain.next = descriptor.nextInChain;
+        m_toggles.chain.sType = WGPUSType_DawnTogglesDescriptor;
+        m_toggles.enabledToggleCount = m_enabledToggles.size();
+        m_toggles.enabledToggles = m_enabledToggles.data();
+        descriptor.nextInChain = &m_toggles.chain;
+    }
+}
+
+void DeviceCapabilities::onDeviceCreated(WGPUDevice device)
+{
+    WGPUSupportedLimits deviceLimits{};
+    if (wgpuDeviceGetLimits(device, &deviceLimits)) {
+        m_limits = deviceLimits.limits;
+    }
+    m_timestampQuery = m_timestampQuery && wgpuDeviceHasFeature(device, WGPUFeatureName_TimestampQuery);
+    m_shaderF16 = m_shaderF16 && wgpuDeviceHasFeature(device, WGPUFeatureName_ShaderF16);
+    m_largeStorageBuffers = m_limits.maxStorageBufferBindingSize >= largeStorageBufferSize;
+}
+
+std::string DeviceCapabilities::describe() const
+{
+    std::ostringstream stream;
+    stream << "tier " << tierName(m_tier)
+           << ", timestamps " << (m_timestampQuery ? "yes" : "no")
+           << ", f16 " << (m_shaderF16 ? "yes" : "no")
+           << ", max storage binding " << (m_limits.maxStorageBufferBindingSize >> 20) << " MiB";
+    return stream.str();
+}
+
+const char *DeviceCapabilities::tierName(Tier tier)
+{
+    switch (tier) {
+    case Tier::Core:
+        return "core";
+    case Tier::HighLimits:
+        return "high";
+    case Tier::Fast:
+        return "fast";
+    }
+    return "invalid";
+}
+
+DeviceCapabilities::Tier DeviceCapabilities::parseTier(const std::string& name)
+{
+    for (Tier tier : { Tier::Core, Tier::HighLimits, Tier::Fast }) {
+        if (name == tierName(tier)) {
+            return tier;
+        }
+    }
+    throw std::runtime_error("Unknown feature tier: " + name);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Negotiates optional features and limits with the adapter and records what
+// the device actually got, so that renderers can pick the fastest path the
+// hardware supports at runtime.
+class DeviceCapabilities
+{
+public:
+    enum class Tier {
+        // WebGPU default limits, no optional features
+        Core,
+        // Adapter limits (large storage buffers) and GPU timestamp queries
+        HighLimits,
+        // HighLimits plus shader-f16
+        Fast,
+    };
+
+    // Storage bindings at least this large count as "large storage buffers"
+    static constexpr uint64_t largeStorageBufferSize = 256ULL * 1024 * 1024;
+
+    // Picks the best tier supported by the adapter, capped at maxTier
+    static DeviceCapabilities fromAdapter(WGPUAdapter adapter, Tier maxTier);
+
+    // Points the descriptor's limits, features and toggles at this object,
+    // which must therefore outlive the device request
+    void configureDeviceDescriptor(WGPUDeviceDescriptor& descriptor);
+
+    // Replaces the requested limits with the ones granted to the device
+    void onDeviceCreated(WGPUDevice device);
+
+    Tier tier() const { return m_tier; }
+    bool timestampQuery() const { return m_timestampQuery; }
+    bool shaderF16() const { return m_shaderF16; }
+    bool largeStorageBuffers() const { return m_largeStorageBuffers; }
+    const WGPULimits& limits() const { return m_limits; }
+
+    std::string describe() const;
+
+    static const char *tierName(Tier tier);
+    static Tier parseTier(const std::string& name);
+
+private:
+    Tier m_tier = Tier::Core;
+    bool m_timestampQuery = false;
+    bool m_shaderF16 = false;
+    bool m_largeStorageBuffers = false;
+    WGPULimits m_limits{};
+
+    std::vector<WGPUFeatureName> m_requiredFeatures;
+    WGPURequiredLimits m_requiredLimits{};
+    std::vector<const char *> m_enabledToggles;
+    WGPUDawnTogglesDescriptor m_toggles{};
+};
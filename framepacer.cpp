@@ -0,0 +1,121 @@
+#include "framepacer.h"
+#include "logger.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+FramePacer::FramePacer(WGPUDevice device, WGPUQueue queue, uint32_t maxFramesInFlight)
+    : m_device(device)
+    , m_queue(queue)
+{
+    setMaxFramesInFlight(maxFramesInFlight);
+    for (FrameSlot& slot : m_slots) {
+        slot.pacer = this;
+    }
+}
+
+FramePacer::~FramePacer()
+{
+    // Pending callbacks point into m_slots
+    waitIdle();
+}
+
+void FramePacer::setMaxFramesInFlight(uint32_t count)
+{
+    m_maxFramesInFlight = std::clamp(count, 1U, maxSupportedFramesInFlight);
+}
+
+void FramePacer::waitForFrameSlot()
+{
+    while (framesInFlight() >= m_maxFramesInFlight) {
+        wgpuDeviceTick(m_device);
+        if (framesInFlight() >= m_maxFramesInFlight) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+void FramePacer::waitIdle()
+{
+    while (framesInFlight() > 0) {
+        wgpuDeviceTick(m_device);
+        if (framesInFlight() > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+void FramePacer::onFrameSubmitted(double inputTime)
+{
+    FrameSlot& slot = m_slots[m_submitted % maxSupportedFramesInFlight];
+    slot.submitTime = glfwGetTime();
+    slot.inputTime = inputTime;
+    ++m_submitted;
+    wgpuQueueOnSubmittedWorkDone(m_queue, &FramePacer::onWorkDone, &slot);
+}
+
+void FramePacer::onWorkDone(WGPUQueueWorkDoneStatus status, void *userData)
+{
+    auto& slot = *reinterpret_cast<FrameSlot *>(userData);
+    if (status != WGPUQueueWorkDoneStatus_Success) {
+        Log::warning() << "Queued work finished with status: " << status;
+    }
+    slot.pacer->onFrameCompleted(slot);
+}
+
+void FramePacer::onFrameCompleted(const FrameSlot& slot)
+{
+    const double now = glfwGetTime();
+    ++m_completed;
+
+    m_gpuTimeHistory[m_gpuTimeSamples++ % historySize] =
+        static_cast<float>((now - slot.submitTime) * 1000.0);
+    if (slot.inputTime >= 0.0) {
+        m_latencyHistory[m_latencySamples++ % historySize] =
+            static_cast<float>((now - slot.inputTime) * 1000.0);
+    }
+}
+
+FramePacer::LatencyStats FramePacer::inputLatency() const
+{
+    LatencyStats stats;
+    const size_t count = std::min<uint64_t>(m_latencySamples, historySize);
+    if (count == 0) {
+        return stats;
+    }
+
+    std::array<float, historySize> sorted = m_latencyHistory;
+    std::sort(sorted.begin(), sorted.begin() + count);
+    stats.lastMs = m_latencyHistory[(m_latencySamples - 1) % historySize];
+    stats.averageMs = std::reduce(sorted.begin(), sorted.begin() + count) / static_cast<float>(count);
+    stats.p95Ms = sorted[std::min(count - 1, count * 95 / 100)];
+    stats.sampleCount = static_cast<uint32_t>(count);
+    return stats;
+}
+
+float FramePacer::averageGpuTimeMs() const
+{
+    const size_t count = std::min<uint64_t>(m_gpuTimeSamples, historySize);
+    if (count == 0) {
+        return 0.0F;
+    }
+    return std::reduce(m_gpuTimeHistory.begin(), m_gpuTimeHistory.begin() + count) / static_cast<float>(count);
+}
+
+float FramePacer::lastGpuTimeMs() const
+{
+    if (m_gpuTimeSamples == 0) {
+        return 0.0F;
+    }
+    return m_gpuTimeHistory[(m_gpuTimeSamples - 1) % historySize];
+}
+
+void FramePacer::resetStats()
+{
+    m_latencySamples = 0;
+    m_gpuTimeSamples = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+
+#include <array>
+#include <cstdint>
+
+// Bounds how far the CPU may run ahead of the GPU and measures, for every
+// frame, the time from its oldest input event to the completion of its GPU work.
+class FramePacer
+{
+public:
+    static constexpr uint32_t maxSupportedFramesInFlight = 8;
+
+    FramePacer(WGPUDevice device, WGPUQueue queue, uint32_t maxFramesInFlight);
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+    ~FramePacer();
+
+    // Blocks, ticking the device, until another frame may be submitted
+    void waitForFrameSlot();
+
+    // Blocks until all submitted frames have completed
+    void waitIdle();
+
+    // To be called right after the frame's wgpuQueueSubmit(). inputTime is the
+    // glfwGetTime() of the oldest input event reflected in the frame, or a
+    // negative value if the frame was not triggered by input.
+    void onFrameSubmitted(double inputTime);
+
+    void setMaxFramesInFlight(uint32_t count);
+    uint32_t maxFramesInFlight() const { return m_maxFramesInFlight; }
+    uint32_t framesInFlight() const { return static_cast<uint32_t>(m_submitted - m_completed); }
+
+    struct LatencyStats {
+        float lastMs = 0.0F;
+        float averageMs = 0.0F;
+        float p95Ms = 0.0F;
+        uint32_t sampleCount = 0;
+    };
+    LatencyStats inputLatency() const;
+    // Average time from submission to GPU completion
+    float averageGpuTimeMs() const;
+    // Submission to GPU completion of the newest completed frame
+    float lastGpuTimeMs() const;
+    void resetStats();
+
+private:
+    struct FrameSlot {
+        FramePacer *pacer = nullptr;
+        double submitTime = 0.0;
+        double inputTime = -1.0;
+    };
+
+    static void onWorkDone(WGPUQueueWorkDoneStatus status, void *userData);
+    void onFrameCompleted(const FrameSlot& slot);
+
+    static constexpr size_t historySize = 128;
+
+    WGPUDevice m_device = nullptr;
+    WGPUQueue m_queue = nullptr;
+    uint32_t m_maxFramesInFlight = 2;
+    uint64_t m_submitted = 0;
+    uint64_t m_completed = 0;
+    std::array<FrameSlot, maxSupportedFramesInFlight> m_slots;
+
+    std::array<float, historySize> m_latencyHistory{};
+    std::array<float, historySize> m_gpuTimeHistory{};
+    uint64_t m_latencySamples = 0;
+    uint64_t m_gpuTimeSamples = 0;
+};
@@ -0,0 +1,141 @@
+#include "gpuresource.h"
+#include "logger.h"
+
+#include <algorithm>
+
+namespace {
+uint64_t bytesPerTexel(WGPUTextureFormat format)
+{
+    switch (format) {
+    case WGPUTextureFormat_R8Unorm:
+        return 1;
+    case WGPUTextureFormat_R16Float:
+        return 2;
+    case WGPUTextureFormat_RGBA16Float:
+    case WGPUTextureFormat_RG32Float:
+        return 8;
+    case WGPUTextureFormat_RGBA32Float:
+        return 16;
+    default:
+        // R32Float, RGBA8Unorm, BGRA8Unorm and the other formats used here
+        return 4;
+    }
+}
+
+// Without padding or compression, which the driver may add
+uint64_t estimateTextureBytes(const WGPUTextureDescriptor& descriptor)
+{
+    uint64_t bytes = 0;
+    uint64_t width = descriptor.size.width;
+    uint64_t height = descriptor.size.height;
+    for (uint32_t level = 0; level < std::max(descriptor.mipLevelCount, 1u); ++level) {
+        bytes += width * height;
+        width = std::max<uint64_t>(width / 2, 1);
+        height = std::max<uint64_t>(height / 2, 1);
+    }
+    return bytes * descriptor.size.depthOrArrayLayers * std::max(descriptor.sampleCount, 1u) *
+           bytesPerTexel(descriptor.format);
+}
+} // namespace
+
+GpuResourceRegistry& GpuResourceRegistry::instance()
+{
+    static GpuResourceRegistry registry;
+    return registry;
+}
+
+const char *GpuResourceRegistry::kindName(Kind kind)
+{
+    constexpr std::array<const char *, kindCount> names = {
+        "instance", "adapter", "device", "queue", "surface", "swap chain", "buffer", "texture", "texture view", "sampler",
+        "query set", "bind group", "bind group layout", "pipeline layout", "shader module", "render pipeline",
+        "compute pipeline"
+    };
+    return names[static_cast<size_t>(kind)];
+}
+
+void GpuResourceRegistry::add(const void *handle, Kind kind, const char *category, uint64_t bytes)
+{
+    std::lock_guard lock(m_mutex);
+    const auto [it, inserted] = m_entries.try_emplace(handle, Entry{ kind, category, bytes });
+    ++it->second.references;
+    if (inserted) {
+        m_totalBytes += bytes;
+    }
+}
+
+void GpuResourceRegistry::remove(const void *handle)
+{
+    std::lock_guard lock(m_mutex);
+    const auto it = m_entries.find(handle);
+    if (it == m_entries.end() || --it->second.references > 0) {
+        return;
+    }
+    m_totalBytes -= it->second.bytes;
+    m_entries.erase(it);
+}
+
+std::vector<GpuResourceRegistry::CategoryUsage> GpuResourceRegistry::usage() const
+{
+    std::vector<CategoryUsage> categories;
+    std::lock_guard lock(m_mutex);
+    for (const auto& [handle, entry] : m_entries) {
+        auto it = std::find_if(categories.begin(), categories.end(), [&](const CategoryUsage& usage) {
+            return usage.category == entry.category;
+        });
+        if (it == categories.end()) {
+            it = categories.insert(categories.end(), CategoryUsage{ entry.category });
+        }
+        ++it->objects;
+        if (entry.kind == Kind::Texture) {
+            it->textureBytes += entry.bytes;
+        }
+        else {
+            it->bufferBytes += entry.bytes;
+        }
+    }
+    std::sort(categories.begin(), categories.end(), [](const CategoryUsage& a, const CategoryUsage& b) {
+        const uint64_t aBytes = a.bufferBytes + a.textureBytes;
+        const uint64_t bBytes = b.bufferBytes + b.textureBytes;
+        return aBytes != bBytes ? aBytes > bBytes : a.objects > b.objects;
+    });
+    return categories;
+}
+
+uint64_t GpuResourceRegistry::liveObjects() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+uint64_t GpuResourceRegistry::totalBytes() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_totalBytes;
+}
+
+size_t GpuResourceRegistry::reportLeaks() const
+{
+    std::lock_guard lock(m_mutex);
+    if (m_entries.empty()) {
+        Log::info() << "No GPU objects leaked";
+        return 0;
+    }
+    Log::warning() << m_entries.size() << " GPU objects still alive at shutdown, " << m_totalBytes << " bytes:";
+    for (const auto& [handle, entry] : m_entries) {
+        Log::warning() << "  " << entry.category << " " << kindName(entry.kind) << " " << handle
+                       << (entry.bytes > 0 ? ", " + std::to_string(entry.bytes) + " bytes" : std::string())
+                       << (entry.references > 1 ? ", " + std::to_string(entry.references) + " references" : std::string());
+    }
+    return m_entries.size();
+}
+
+GpuBuffer createGpuBuffer(WGPUDevice device, const WGPUBufferDescriptor& descriptor, const char *category)
+{
+    return GpuBuffer(wgpuDeviceCreateBuffer(device, &descriptor), category, descriptor.size);
+}
+
+GpuTexture createGpuTexture(WGPUDevice device, const WGPUTextureDescriptor& descriptor, const char *category)
+{
+    return GpuTexture(wgpuDeviceCreateTexture(device, &descriptor), category, estimateTextureBytes(descriptor));
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Every WGPU object owned through a GpuHandle, with the estimated GPU memory
+// of buffers and textures, grouped by the category given at creation. Dawn
+// returns the same object with another reference for identical layouts,
+// samplers, shader modules and pipelines, so objects are counted once and
+// only removed with their last handle.
+class GpuResourceRegistry
+{
+public:
+    enum class Kind : uint8_t {
+        Instance, Adapter, Device, Queue, Surface, SwapChain, Buffer, Texture, TextureView, Sampler, QuerySet,
+        BindGroup, BindGroupLayout, PipelineLayout, ShaderModule, RenderPipeline, ComputePipeline
+    };
+    static constexpr size_t kindCount = static_cast<size_t>(Kind::ComputePipeline) + 1;
+
+    struct CategoryUsage {
+        std::string category;
+        uint32_t objects = 0;
+        uint64_t bufferBytes = 0;
+        uint64_t textureBytes = 0;
+    };
+
+    static GpuResourceRegistry& instance();
+    static const char *kindName(Kind kind);
+
+    GpuResourceRegistry(const GpuResourceRegistry&) = delete;
+    GpuResourceRegistry& operator=(const GpuResourceRegistry&) = delete;
+
+    void add(const void *handle, Kind kind, const char *category, uint64_t bytes);
+    void remove(const void *handle);
+
+    // Sorted by memory, then by object count
+    std::vector<CategoryUsage> usage() const;
+    uint64_t liveObjects() const;
+    uint64_t totalBytes() const;
+
+    // Logs every object that is still alive and returns how many there are
+    size_t reportLeaks() const;
+
+private:
+    struct Entry {
+        Kind kind = Kind::Buffer;
+        // String literal naming the owner, e.g. "Histogram"
+        const char *category = nullptr;
+        uint64_t bytes = 0;
+        // Handles holding a reference to the object
+        uint32_t references = 0;
+    };
+
+    GpuResourceRegistry() = default;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<const void *, Entry> m_entries;
+    uint64_t m_totalBytes = 0;
+};
+
+// Owns one reference to a WGPU object and releases it on destruction. It
+// converts to the raw handle, so it can be passed to the C API directly.
+template <typename Handle, void (*releaseHandle)(Handle), GpuResourceRegistry::Kind kind>
+class GpuHandle
+{
+public:
+    GpuHandle() = default;
+
+    // Takes over a reference, e.g. the one returned by wgpuDeviceCreate*()
+    GpuHandle(Handle handle, const char *category, uint64_t bytes = 0)
+        : m_handle(handle)
+    {
+        if (m_handle != nullptr) {
+            GpuResourceRegistry::instance().add(m_handle, kind, category, bytes);
+        }
+    }
+
+    GpuHandle(const GpuHandle&) = delete;
+    GpuHandle& operator=(const GpuHandle&) = delete;
+
+    GpuHandle(GpuHandle&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, nullptr))
+    {
+    }
+
+    GpuHandle& operator=(GpuHandle&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+
+    ~GpuHandle() { reset(); }
+
+    void reset()
+    {
+        if (m_handle != nullptr) {
+            GpuResourceRegistry::instance().remove(m_handle);
+            releaseHandle(m_handle);
+            m_handle = nullptr;
+        }
+    }
+
+    Handle get() const { return m_handle; }
+    operator Handle() const { return m_handle; }
+
+private:
+    Handle m_handle = nullptr;
+};
+
+using GpuInstance = GpuHandle<WGPUInstance, wgpuInstanceRelease, GpuResourceRegistry::Kind::Instance>;
+using GpuAdapter = GpuHandle<WGPUAdapter, wgpuAdapterRelease, GpuResourceRegistry::Kind::Adapter>;
+using GpuDevice = GpuHandle<WGPUDevice, wgpuDeviceRelease, GpuResourceRegistry::Kind::Device>;
+using GpuQueue = GpuHandle<WGPUQueue, wgpuQueueRelease, GpuResourceRegistry::Kind::Queue>;
+using GpuSurface = GpuHandle<WGPUSurface, wgpuSurfaceRelease, GpuResourceRegistry::Kind::Surface>;
+using GpuSwapChain = GpuHandle<WGPUSwapChain, wgpuSwapChainRelease, GpuResourceRegistry::Kind::SwapChain>;
+using GpuBuffer = GpuHandle<WGPUBuffer, wgpuBufferRelease, GpuResourceRegistry::Kind::Buffer>;
+using GpuTexture = GpuHandle<WGPUTexture, wgpuTextureRelease, GpuResourceRegistry::Kind::Texture>;
+using GpuTextureView = GpuHandle<WGPUTextureView, wgpuTextureViewRelease, GpuResourceRegistry::Kind::TextureView>;
+using GpuSampler = GpuHandle<WGPUSampler, wgpuSamplerRelease, GpuResourceRegistry::Kind::Sampler>;
+using GpuQuerySet = GpuHandle<WGPUQuerySet, wgpuQuerySetRelease, GpuResourceRegistry::Kind::QuerySet>;
+using GpuBindGroup = GpuHandle<WGPUBindGroup, wgpuBindGroupRelease, GpuResourceRegistry::Kind::BindGroup>;
+using GpuBindGroupLayout = GpuHandle<WGPUBindGroupLayout, wgpuBindGroupLayoutRelease, GpuResourceRegistry::Kind::BindGroupLayout>;
+using GpuPipelineLayout = GpuHandle<WGPUPipelineLayout, wgpuPipelineLayoutRelease, GpuResourceRegistry::Kind::PipelineLayout>;
+using GpuShaderModule = GpuHandle<WGPUShaderModule, wgpuShaderModuleRelease, GpuResourceRegistry::Kind::ShaderModule>;
+using GpuRenderPipeline = GpuHandle<WGPURenderPipeline, wgpuRenderPipelineRelease, GpuResourceRegistry::Kind::RenderPipeline>;
+using GpuComputePipeline = GpuHandle<WGPUComputePipeline, wgpuComputePipelineRelease, GpuResourceRegistry::Kind::ComputePipeline>;
+
+// Creation helpers that record the size of the allocation
+GpuBuffer createGpuBuffer(WGPUDevice device, const WGPUBufferDescriptor& descriptor, const char *category);
+GpuTexture createGpuTexture(WGPUDevice device, const WGPUTextureDescriptor& descriptor, const char *category);
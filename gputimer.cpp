@@ -0,0 +1,77 @@
+#include "gputimer.h"
+#include "utils.h"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+constexpr const char *resourceCategory = "GPU timer";
+constexpr uint64_t timestampsSize = 2 * sizeof(uint64_t);
+} // namespace
+
+GpuTimer::GpuTimer(WGPUDevice device)
+    : m_device(device)
+{
+    WGPUQuerySetDescriptor querySetDesc{};
+    querySetDesc.nextInChain = nullptr;
+    querySetDesc.label = "GPU timer";
+    querySetDesc.type = WGPUQueryType_Timestamp;
+    querySetDesc.count = 2;
+    m_querySet = GpuQuerySet(wgpuDeviceCreateQuerySet(m_device, &querySetDesc), resourceCategory);
+
+    WGPUBufferDescriptor bufferDesc{};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.mappedAtCreation = false;
+    bufferDesc.label = "GPU timer timestamps";
+    bufferDesc.size = timestampsSize;
+    bufferDesc.usage = WGPUBufferUsage_QueryResolve | WGPUBufferUsage_CopySrc;
+    m_resolveBuffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+    bufferDesc.label = "GPU timer readback";
+    bufferDesc.usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+    m_readbackBuffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+}
+
+void GpuTimer::writeTimestamp(WGPUCommandEncoder encoder, uint32_t index)
+{
+    WGPUComputePassTimestampWrites timestampWrites{};
+    timestampWrites.querySet = m_querySet;
+    timestampWrites.beginningOfPassWriteIndex = index;
+    timestampWrites.endOfPassWriteIndex = WGPU_QUERY_SET_INDEX_UNDEFINED;
+
+    WGPUComputePassDescriptor computePassDesc{};
+    computePassDesc.nextInChain = nullptr;
+    computePassDesc.label = "GPU timestamp";
+    computePassDesc.timestampWrites = &timestampWrites;
+    WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(encoder, &computePassDesc);
+    wgpuComputePassEncoderEnd(pass);
+    wgpuComputePassEncoderRelease(pass);
+}
+
+void GpuTimer::begin(WGPUCommandEncoder encoder)
+{
+    writeTimestamp(encoder, 0);
+}
+
+void GpuTimer::end(WGPUCommandEncoder encoder)
+{
+    writeTimestamp(encoder, 1);
+    wgpuCommandEncoderResolveQuerySet(encoder, m_querySet, 0, 2, m_resolveBuffer, 0);
+    wgpuCommandEncoderCopyBufferToBuffer(encoder, m_resolveBuffer, 0, m_readbackBuffer, 0, timestampsSize);
+}
+
+double GpuTimer::read()
+{
+    if (!Utils::mapBufferAndWait(m_device, m_readbackBuffer, WGPUMapMode_Read, timestampsSize)) {
+        throw std::runtime_error("Failed to read back GPU timestamps");
+    }
+
+    std::array<uint64_t, 2> timestamps{};
+    std::memcpy(timestamps.data(), wgpuBufferGetConstMappedRange(m_readbackBuffer, 0, timestampsSize), timestampsSize);
+    wgpuBufferUnmap(m_readbackBuffer);
+    // Nanoseconds, which are not guaranteed to increase
+    if (timestamps[1] <= timestamps[0]) {
+        return 0.0;
+    }
+    return static_cast<double>(timestamps[1] - timestamps[0]) * 1e-6;
+}
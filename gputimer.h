@@ -0,0 +1,33 @@
+#pragma once
+
+#include "gpuresource.h"
+
+#include <webgpu/webgpu.h>
+
+// GPU time between two points of a command encoder, from timestamp queries.
+// They are written by empty compute passes, so the passes recorded in between
+// are measured without the present pass or anything else in the frame.
+// Requires the timestamp-query feature.
+class GpuTimer
+{
+public:
+    explicit GpuTimer(WGPUDevice device);
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin(WGPUCommandEncoder encoder);
+    // Also records copying the timestamps out for read()
+    void end(WGPUCommandEncoder encoder);
+
+    // Blocks, ticking the device, until the commands recorded by the last
+    // end() have been submitted and completed, and returns their time in ms
+    double read();
+
+private:
+    void writeTimestamp(WGPUCommandEncoder encoder, uint32_t index);
+
+    WGPUDevice m_device = nullptr;
+    GpuQuerySet m_querySet;
+    GpuBuffer m_resolveBuffer;
+    GpuBuffer m_readbackBuffer;
+};
@@ -0,0 +1,120 @@
+#include "histogramcoloring.h"
+#include "utils.h"
+
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+constexpr uint32_t histogramWorkgroupSize = 16;
+constexpr const char *resourceCategory = "Histogram";
+} // namespace
+
+HistogramColoring::HistogramColoring(WGPUDevice device, RenderTargetPool& renderTargets, WGPUBuffer uniformBuffer,
+                                     uint64_t uniformSize, WGPUTextureFormat targetFormat)
+    : m_device(device)
+    , m_renderTargets(renderTargets)
+    , m_uniformBuffer(uniformBuffer)
+    , m_uniformSize(uniformSize)
+{
+    m_shaderModule = GpuShaderModule(Utils::loadShaderModule("shaders/histogram.wgsl", m_device), resourceCategory);
+    if (!m_shaderModule) {
+        throw std::runtime_error("Failed to load the histogram shaders!");
+    }
+
+    m_histogramPipeline = GpuComputePipeline(
+        Utils::createComputePipeline(m_device, m_shaderModule, "cs_histogram"), resourceCategory);
+    m_scanPipeline = GpuComputePipeline(Utils::createComputePipeline(m_device, m_shaderModule, "cs_scan"), resourceCategory);
+
+    m_colorizePipeline = GpuRenderPipeline(
+        Utils::createFullscreenPipeline(m_device, m_shaderModule, "fs_colorize", targetFormat), resourceCategory);
+
+    WGPUBufferDescriptor bufferDesc{};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.size = binCount * sizeof(uint32_t);
+    bufferDesc.mappedAtCreation = false;
+    bufferDesc.label = "Iteration histogram";
+    bufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+    m_histogramBuffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+    bufferDesc.label = "Iteration CDF";
+    bufferDesc.usage = WGPUBufferUsage_Storage;
+    m_cdfBuffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+
+    m_scanBindGroup = GpuBindGroup(Utils::createBindGroup(m_device, wgpuComputePipelineGetBindGroupLayout(m_scanPipeline, 0),
+        std::array{
+            Utils::bufferBindGroupEntry(2, m_histogramBuffer, bufferDesc.size),
+            Utils::bufferBindGroupEntry(3, m_cdfBuffer, bufferDesc.size),
+        }), resourceCategory);
+}
+
+HistogramColoring::~HistogramColoring()
+{
+    releaseSizedResources();
+}
+
+void HistogramColoring::releaseSizedResources()
+{
+    m_colorizeBindGroup.reset();
+    m_histogramBindGroup.reset();
+    m_renderTargets.release(std::exchange(m_iterationTarget, nullptr));
+}
+
+void HistogramColoring::resize(uint32_t width, uint32_t height)
+{
+    m_width = width;
+    m_height = height;
+    if (m_iterationTarget != nullptr && m_iterationTarget->fits(width, height)) {
+        return;
+    }
+    releaseSizedResources();
+    // Copied out by the budget benchmark's escape time check
+    m_iterationTarget = m_renderTargets.acquire(iterationFormat,
+                                                WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_TextureBinding |
+                                                    WGPUTextureUsage_CopySrc,
+                                                width, height, "Iteration counts");
+
+    m_histogramBindGroup = GpuBindGroup(Utils::createBindGroup(m_device, wgpuComputePipelineGetBindGroupLayout(m_histogramPipeline, 0),
+        std::array{
+            Utils::bufferBindGroupEntry(0, m_uniformBuffer, m_uniformSize),
+            Utils::textureBindGroupEntry(1, m_iterationTarget->view),
+            Utils::bufferBindGroupEntry(2, m_histogramBuffer, binCount * sizeof(uint32_t)),
+        }), resourceCategory);
+    m_colorizeBindGroup = GpuBindGroup(Utils::createBindGroup(m_device, wgpuRenderPipelineGetBindGroupLayout(m_colorizePipeline, 0),
+        std::array{
+            Utils::bufferBindGroupEntry(0, m_uniformBuffer, m_uniformSize),
+            Utils::textureBindGroupEntry(1, m_iterationTarget->view),
+            Utils::bufferBindGroupEntry(3, m_cdfBuffer, binCount * sizeof(float)),
+        }), resourceCategory);
+}
+
+void HistogramColoring::encode(WGPUCommandEncoder encoder)
+{
+    wgpuCommandEncoderClearBuffer(encoder, m_histogramBuffer, 0, binCount * sizeof(uint32_t));
+
+    WGPUComputePassDescriptor computePassDesc{};
+    computePassDesc.nextInChain = nullptr;
+    computePassDesc.label = "Histogram";
+    computePassDesc.timestampWrites = nullptr;
+    WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(encoder, &computePassDesc);
+
+    wgpuComputePassEncoderSetPipeline(pass, m_histogramPipeline);
+    wgpuComputePassEncoderSetBindGroup(pass, 0, m_histogramBindGroup, 0, nullptr);
+    wgpuComputePassEncoderDispatchWorkgroups(pass,
+        (m_width + histogramWorkgroupSize - 1) / histogramWorkgroupSize,
+        (m_height + histogramWorkgroupSize - 1) / histogramWorkgroupSize, 1);
+
+    // Dispatches within a pass are ordered, so the scan sees every count
+    wgpuComputePassEncoderSetPipeline(pass, m_scanPipeline);
+    wgpuComputePassEncoderSetBindGroup(pass, 0, m_scanBindGroup, 0, nullptr);
+    wgpuComputePassEncoderDispatchWorkgroups(pass, 1, 1, 1);
+
+    wgpuComputePassEncoderEnd(pass);
+    wgpuComputePassEncoderRelease(pass);
+}
+
+void HistogramColoring::draw(WGPURenderPassEncoder pass)
+{
+    wgpuRenderPassEncoderSetPipeline(pass, m_colorizePipeline);
+    wgpuRenderPassEncoderSetBindGroup(pass, 0, m_colorizeBindGroup, 0, nullptr);
+    wgpuRenderPassEncoderDraw(pass, 3, 1, 0, 0);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "gpuresource.h"
+#include "rendertargetpool.h"
+
+#include <webgpu/webgpu.h>
+
+#include <cstdint>
+
+// GPU histogram equalization of escape times. The fractal kernels render raw
+// iteration counts into iterationTarget(), encode() builds the histogram and
+// its CDF with compute passes, and draw() maps every pixel through the CDF.
+// Nothing is read back to the CPU.
+class HistogramColoring
+{
+public:
+    static constexpr WGPUTextureFormat iterationFormat = WGPUTextureFormat_R32Float;
+    static constexpr uint32_t binCount = 1024;
+
+    HistogramColoring(WGPUDevice device, RenderTargetPool& renderTargets, WGPUBuffer uniformBuffer,
+                      uint64_t uniformSize, WGPUTextureFormat targetFormat);
+    HistogramColoring(const HistogramColoring&) = delete;
+    HistogramColoring& operator=(const HistogramColoring&) = delete;
+    ~HistogramColoring();
+
+    void resize(uint32_t width, uint32_t height);
+
+    // Covers the size given to resize() from its top left corner
+    WGPUTextureView iterationTarget() const { return m_iterationTarget->view; }
+    WGPUTexture iterationTexture() const { return m_iterationTarget->texture; }
+
+    // Records the histogram and prefix sum passes
+    void encode(WGPUCommandEncoder encoder);
+
+    // Draws the colorized image into the current render pass
+    void draw(WGPURenderPassEncoder pass);
+
+private:
+    void releaseSizedResources();
+
+    WGPUDevice m_device = nullptr;
+    RenderTargetPool& m_renderTargets;
+    WGPUBuffer m_uniformBuffer = nullptr;
+    uint64_t m_uniformSize = 0;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+
+    GpuShaderModule m_shaderModule;
+    GpuComputePipeline m_histogramPipeline;
+    GpuComputePipeline m_scanPipeline;
+    GpuRenderPipeline m_colorizePipeline;
+    GpuBuffer m_histogramBuffer;
+    GpuBuffer m_cdfBuffer;
+    GpuBindGroup m_scanBindGroup;
+
+    // Replaced when a resize leaves the target's size bucket
+    RenderTargetPool::Target *m_iterationTarget = nullptr;
+    GpuBindGroup m_histogramBindGroup;
+    GpuBindGroup m_colorizeBindGroup;
+};
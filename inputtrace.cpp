@@ -0,0 +1,164 @@
+#include "inputtrace.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+constexpr std::array<char, 4> traceMagic = { 'W', 'G', 'T', 'R' };
+// Version 1 had no launch settings
+constexpr uint16_t traceVersion = 2;
+
+template <typename T>
+T read(std::ifstream& file)
+{
+    T value{};
+    file.read(reinterpret_cast<char *>(&value), sizeof(T));
+    return value;
+}
+} // namespace
+
+InputTrace InputTrace::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open input trace: " + path);
+    }
+    const auto magic = read<std::array<char, 4>>(file);
+    const auto version = read<uint16_t>(file);
+    if (!file || magic != traceMagic || version < 1 || version > traceVersion) {
+        throw std::runtime_error("Not a supported input trace: " + path);
+    }
+
+    InputTrace trace;
+    if (version >= 2) {
+        LaunchSettings launch;
+        launch.presentMode = read<uint32_t>(file);
+        launch.featureTier = read<uint8_t>(file);
+        launch.maxFramesInFlight = read<uint8_t>(file);
+        launch.continuous = read<uint8_t>(file) != 0;
+        launch.renderThread = read<uint8_t>(file) != 0;
+        if (!file) {
+            throw std::runtime_error("Truncated input trace: " + path);
+        }
+        trace.m_launchSettings = launch;
+    }
+    double time = 0.0;
+    while (true) {
+        const auto type = read<uint8_t>(file);
+        const auto delta = read<uint32_t>(file);
+        if (!file) {
+            break;
+        }
+        time += delta * 1e-6;
+
+        Event event;
+        event.type = static_cast<EventType>(type);
+        event.time = time;
+        switch (event.type) {
+        case EventType::MouseMove:
+        case EventType::Scroll:
+            event.x = read<float>(file);
+            event.y = read<float>(file);
+            break;
+        case EventType::MouseButton:
+            for (size_t i = 0; i < event.ints.size(); ++i) {
+                event.ints[i] = read<uint8_t>(file);
+            }
+            event.x = read<float>(file);
+            event.y = read<float>(file);
+            break;
+        case EventType::Resize:
+            for (int32_t& value : event.ints) {
+                value = read<uint16_t>(file);
+            }
+            break;
+        case EventType::Setting:
+            event.ints[0] = read<uint8_t>(file);
+            event.value = read<double>(file);
+            break;
+        default:
+            throw std::runtime_error("Corrupt input trace: " + path);
+        }
+        if (!file) {
+            throw std::runtime_error("Truncated input trace: " + path);
+        }
+        trace.m_events.push_back(event);
+    }
+    return trace;
+}
+
+InputRecorder::InputRecorder(const std::string& path, const InputTrace::LaunchSettings& launchSettings)
+    : m_file(path, std::ios::binary | std::ios::trunc)
+    , m_previousTime(std::chrono::steady_clock::now())
+{
+    if (!m_file) {
+        throw std::runtime_error("Failed to create input trace: " + path);
+    }
+    write(traceMagic);
+    write(traceVersion);
+    write(launchSettings.presentMode);
+    write(launchSettings.featureTier);
+    write(launchSettings.maxFramesInFlight);
+    write(static_cast<uint8_t>(launchSettings.continuous ? 1 : 0));
+    write(static_cast<uint8_t>(launchSettings.renderThread ? 1 : 0));
+}
+
+std::unique_lock<std::mutex> InputRecorder::beginRecord(InputTrace::EventType type)
+{
+    std::unique_lock lock(m_mutex);
+    const auto now = std::chrono::steady_clock::now();
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(now - m_previousTime).count();
+    // Only the rounded delta is consumed, so rounding errors do not add up
+    m_previousTime += std::chrono::microseconds(delta);
+    write(static_cast<uint8_t>(type));
+    write(static_cast<uint32_t>(std::min<int64_t>(delta, std::numeric_limits<uint32_t>::max())));
+    ++m_eventCount;
+    return lock;
+}
+
+void InputRecorder::mouseMove(double x, double y)
+{
+    const auto lock = beginRecord(InputTrace::EventType::MouseMove);
+    write(static_cast<float>(x));
+    write(static_cast<float>(y));
+}
+
+void InputRecorder::scroll(double x, double y)
+{
+    const auto lock = beginRecord(InputTrace::EventType::Scroll);
+    write(static_cast<float>(x));
+    write(static_cast<float>(y));
+}
+
+void InputRecorder::mouseButton(int button, int action, int mods, double x, double y, bool guiCaptured)
+{
+    const auto lock = beginRecord(InputTrace::EventType::MouseButton);
+    write(static_cast<uint8_t>(button));
+    write(static_cast<uint8_t>(action));
+    write(static_cast<uint8_t>(mods));
+    write(static_cast<uint8_t>(guiCaptured ? 1 : 0));
+    write(static_cast<float>(x));
+    write(static_cast<float>(y));
+}
+
+void InputRecorder::resize(int framebufferWidth, int framebufferHeight, int windowWidth, int windowHeight)
+{
+    const auto lock = beginRecord(InputTrace::EventType::Resize);
+    for (int value : { framebufferWidth, framebufferHeight, windowWidth, windowHeight }) {
+        write(static_cast<uint16_t>(std::clamp(value, 0, int(std::numeric_limits<uint16_t>::max()))));
+    }
+}
+
+void InputRecorder::setting(uint8_t id, double value)
+{
+    const auto lock = beginRecord(InputTrace::EventType::Setting);
+    write(id);
+    write(value);
+}
+
+uint64_t InputRecorder::eventCount() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_eventCount;
+}
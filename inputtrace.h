@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Compact binary log of the input that drives Application: the window
+// callbacks that move the view and the changes made through the overlay.
+// The header holds the launch settings of the recorded run. Every record is
+// a type byte, the time since the previous record in microseconds and a
+// fixed payload, in native byte order.
+class InputTrace
+{
+public:
+    enum class EventType : uint8_t { MouseMove, Scroll, MouseButton, Resize, Setting };
+
+    struct Event {
+        EventType type = EventType::MouseMove;
+        // Seconds since the start of the recording
+        double time = 0.0;
+        // Cursor position or scroll offsets
+        double x = 0.0;
+        double y = 0.0;
+        // Button, action, mods and whether the overlay had the mouse;
+        // framebuffer and window size; or the setting in the first element
+        std::array<int32_t, 4> ints{};
+        // New value of a setting
+        double value = 0.0;
+    };
+
+    // Launch options of the recorded run that change the rendering workload
+    struct LaunchSettings {
+        // WGPUPresentMode
+        uint32_t presentMode = 0;
+        // DeviceCapabilities::Tier
+        uint8_t featureTier = 0;
+        uint8_t maxFramesInFlight = 2;
+        bool continuous = false;
+        bool renderThread = true;
+    };
+
+    static InputTrace load(const std::string& path);
+
+    // Missing from traces of the first version
+    const std::optional<LaunchSettings>& launchSettings() const { return m_launchSettings; }
+    const std::vector<Event>& events() const { return m_events; }
+    double duration() const { return m_events.empty() ? 0.0 : m_events.back().time; }
+
+private:
+    std::optional<LaunchSettings> m_launchSettings;
+    std::vector<Event> m_events;
+};
+
+// Appends events to a trace file. Window callbacks and overlay changes come
+// from different threads, so every write takes a lock.
+class InputRecorder
+{
+public:
+    InputRecorder(const std::string& path, const InputTrace::LaunchSettings& launchSettings);
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    void mouseMove(double x, double y);
+    void scroll(double x, double y);
+    void mouseButton(int button, int action, int mods, double x, double y, bool guiCaptured);
+    void resize(int framebufferWidth, int framebufferHeight, int windowWidth, int windowHeight);
+    void setting(uint8_t id, double value);
+
+    uint64_t eventCount() const;
+
+private:
+    // Writes the record header and returns with the lock held
+    std::unique_lock<std::mutex> beginRecord(InputTrace::EventType type);
+
+    template <typename T>
+    void write(const T& value)
+    {
+        m_file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    mutable std::mutex m_mutex;
+    std::ofstream m_file;
+    std::chrono::steady_clock::time_point m_previousTime;
+    uint64_t m_eventCount = 0;
+};
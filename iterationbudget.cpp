@@ -0,0 +1,122 @@
+#include "iterationbudget.h"
+#include "utils.h"
+
+#include <cstring>
+
+namespace {
+constexpr const char *resourceCategory = "Iteration budget";
+} // namespace
+
+IterationBudget::IterationBudget(WGPUDevice device, WGPUBuffer uniformBuffer, uint64_t uniformSize)
+    : m_device(device)
+    , m_uniformBuffer(uniformBuffer)
+    , m_uniformSize(uniformSize)
+{
+    WGPUBufferDescriptor bufferDesc{};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.mappedAtCreation = false;
+    bufferDesc.label = "Tile iteration budgets";
+    bufferDesc.size = tileBufferSize();
+    bufferDesc.usage = WGPUBufferUsage_Storage;
+    m_tileBuffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+    bufferDesc.label = "Iteration budget totals";
+    bufferDesc.size = statsBufferSize();
+    bufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopySrc | WGPUBufferUsage_CopyDst;
+    m_statsBuffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+
+    bufferDesc.label = "Iteration budget readback";
+    bufferDesc.usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+    for (Readback& readback : m_readbacks) {
+        readback.buffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+    }
+}
+
+IterationBudget::~IterationBudget()
+{
+    for (Readback& readback : m_readbacks) {
+        // Unmapping rejects a pending map, whose callback then runs while
+        // this object is still alive
+        if (readback.state == Readback::State::Mapping || readback.state == Readback::State::Mapped) {
+            wgpuBufferUnmap(readback.buffer);
+        }
+    }
+}
+
+void IterationBudget::createEstimator(PrecisionManager::Tier tier, WGPUShaderModule module)
+{
+    const auto index = static_cast<size_t>(tier);
+    m_pipelines[index] = GpuComputePipeline(Utils::createComputePipeline(m_device, module, "cs_estimate"), resourceCategory);
+    m_bindGroups[index] = GpuBindGroup(Utils::createBindGroup(m_device, wgpuComputePipelineGetBindGroupLayout(m_pipelines[index], 0),
+        std::array{
+            Utils::bufferBindGroupEntry(0, m_uniformBuffer, m_uniformSize),
+            Utils::bufferBindGroupEntry(1, m_tileBuffer, tileBufferSize()),
+            Utils::bufferBindGroupEntry(2, m_statsBuffer, statsBufferSize()),
+        }), resourceCategory);
+}
+
+void IterationBudget::onReadbackMapped(WGPUBufferMapAsyncStatus status, void *userdata)
+{
+    auto *readback = static_cast<Readback *>(userdata);
+    readback->state = status == WGPUBufferMapAsyncStatus_Success ? Readback::State::Mapped
+                                                                 : Readback::State::Free;
+}
+
+void IterationBudget::collectReadbacks()
+{
+    for (Readback& readback : m_readbacks) {
+        if (readback.state != Readback::State::Mapped) {
+            continue;
+        }
+        const void *data = wgpuBufferGetConstMappedRange(readback.buffer, 0, sizeof(Stats));
+        if (data != nullptr) {
+            std::memcpy(&m_stats, data, sizeof(Stats));
+        }
+        wgpuBufferUnmap(readback.buffer);
+        readback.state = Readback::State::Free;
+    }
+}
+
+void IterationBudget::encode(WGPUCommandEncoder encoder, PrecisionManager::Tier tier,
+                             uint32_t width, uint32_t height)
+{
+    collectReadbacks();
+    const auto index = static_cast<size_t>(tier);
+    if (m_pipelines[index] == nullptr) {
+        return;
+    }
+
+    wgpuCommandEncoderClearBuffer(encoder, m_statsBuffer, 0, statsBufferSize());
+
+    WGPUComputePassDescriptor computePassDesc{};
+    computePassDesc.nextInChain = nullptr;
+    computePassDesc.label = "Iteration budget estimate";
+    computePassDesc.timestampWrites = nullptr;
+    WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(encoder, &computePassDesc);
+    wgpuComputePassEncoderSetPipeline(pass, m_pipelines[index]);
+    wgpuComputePassEncoderSetBindGroup(pass, 0, m_bindGroups[index], 0, nullptr);
+    wgpuComputePassEncoderDispatchWorkgroups(pass, (width + tileSize - 1) / tileSize,
+                                             (height + tileSize - 1) / tileSize, 1);
+    wgpuComputePassEncoderEnd(pass);
+    wgpuComputePassEncoderRelease(pass);
+
+    // Skipped while every readback buffer is still in use, the overlay only
+    // needs a recent value
+    for (Readback& readback : m_readbacks) {
+        if (readback.state == Readback::State::Free) {
+            wgpuCommandEncoderCopyBufferToBuffer(encoder, m_statsBuffer, 0, readback.buffer, 0, statsBufferSize());
+            readback.state = Readback::State::Copied;
+            break;
+        }
+    }
+}
+
+void IterationBudget::onSubmitted()
+{
+    for (Readback& readback : m_readbacks) {
+        if (readback.state == Readback::State::Copied) {
+            readback.state = Readback::State::Mapping;
+            wgpuBufferMapAsync(readback.buffer, WGPUMapMode_Read, 0, sizeof(Stats),
+                               &IterationBudget::onReadbackMapped, &readback);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "gpuresource.h"
+#include "precisionmanager.h"
+
+#include <webgpu/webgpu.h>
+
+#include <array>
+#include <cstdint>
+
+// Adaptive per-tile iteration budgets. encode() runs the cs_estimate entry
+// point that shaders/budget.wgsl adds to every fractal kernel, which probes a sparse grid of every tile and
+// writes the iteration count the tile needs into tileBuffer(). The fragment
+// shaders read the budgets from there: every tile gets at least
+// max_iterations, and the iterations left unused by tiles that escape early
+// are shared by the tiles that need more. The totals are read back
+// asynchronously for the overlay.
+class IterationBudget
+{
+public:
+    // Must match the constants in shaders/budget.wgsl
+    static constexpr uint32_t tileSize = 64;
+    static constexpr uint32_t maxTiles = 16384;
+
+    struct Stats {
+        // Iterations asked for beyond max_iterations, summed over all tiles
+        uint32_t boostDemand = 0;
+        // Iterations below max_iterations that tiles are estimated not to use
+        uint32_t spareIterations = 0;
+        uint32_t maxDemand = 0;
+        uint32_t boundaryTiles = 0;
+        uint32_t tiles = 0;
+
+        // Fraction of the boost demand that is granted, as in pixel_budget()
+        double boostScale() const
+        {
+            return boostDemand > spareIterations ? static_cast<double>(spareIterations) / boostDemand : 1.0;
+        }
+    };
+
+    IterationBudget(WGPUDevice device, WGPUBuffer uniformBuffer, uint64_t uniformSize);
+    IterationBudget(const IterationBudget&) = delete;
+    IterationBudget& operator=(const IterationBudget&) = delete;
+    ~IterationBudget();
+
+    WGPUBuffer tileBuffer() const { return m_tileBuffer; }
+    uint64_t tileBufferSize() const { return maxTiles * sizeof(uint32_t); }
+    WGPUBuffer statsBuffer() const { return m_statsBuffer; }
+    uint64_t statsBufferSize() const { return sizeof(Stats); }
+
+    // Builds the estimator of one precision tier from its fractal kernel
+    void createEstimator(PrecisionManager::Tier tier, WGPUShaderModule module);
+
+    // Records the estimation for a view of the given framebuffer size
+    void encode(WGPUCommandEncoder encoder, PrecisionManager::Tier tier, uint32_t width, uint32_t height);
+
+    // Starts reading back the totals of the frame that was just submitted
+    void onSubmitted();
+
+    // Totals of the newest estimate that has been read back
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Readback {
+        enum class State { Free, Copied, Mapping, Mapped };
+        GpuBuffer buffer;
+        State state = State::Free;
+    };
+
+    static void onReadbackMapped(WGPUBufferMapAsyncStatus status, void *userdata);
+    void collectReadbacks();
+
+    WGPUDevice m_device = nullptr;
+    WGPUBuffer m_uniformBuffer = nullptr;
+    uint64_t m_uniformSize = 0;
+    GpuBuffer m_tileBuffer;
+    GpuBuffer m_statsBuffer;
+    std::array<GpuComputePipeline, PrecisionManager::tierCount> m_pipelines;
+    std::array<GpuBindGroup, PrecisionManager::tierCount> m_bindGroups;
+    std::array<Readback, 3> m_readbacks;
+    Stats m_stats;
+};
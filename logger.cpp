@@ -0,0 +1,182 @@
+#include "logger.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+// How long the writer sleeps when only debug and info lines are queued
+constexpr std::chrono::milliseconds flushInterval(20);
+
+const char *levelName(LogLevel level)
+{
+    switch (level) {
+    case LogLevel::Debug: return "debug";
+    case LogLevel::Info: return "info";
+    case LogLevel::Warning: return "warning";
+    case LogLevel::Error: return "error";
+    }
+    return "";
+}
+} // namespace
+
+Logger& Logger::instance()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : m_startTime(std::chrono::steady_clock::now())
+{
+    m_thread = std::thread([this]() { run(); });
+}
+
+Logger::~Logger()
+{
+    {
+        std::lock_guard lock(m_wakeMutex);
+        m_running = false;
+    }
+    m_wakeCondition.notify_one();
+    m_thread.join();
+}
+
+Logger::RecordQueue& Logger::threadQueue()
+{
+    thread_local RecordQueue *queue = nullptr;
+    if (queue == nullptr) {
+        std::lock_guard lock(m_queuesMutex);
+        queue = m_queues.emplace_back(std::make_unique<RecordQueue>()).get();
+    }
+    return *queue;
+}
+
+void Logger::write(LogLevel level, std::string_view text)
+{
+    Record record;
+    record.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_startTime).count();
+    record.level = level;
+    if (text.size() <= maxMessageLength) {
+        record.length = static_cast<uint8_t>(text.size());
+        std::copy_n(text.data(), record.length, record.text.begin());
+    }
+    else if (level == LogLevel::Error) {
+        record.longText = new std::string(text);
+    }
+    else {
+        constexpr std::string_view ellipsis = "...";
+        record.length = static_cast<uint8_t>(maxMessageLength);
+        const auto end = std::copy_n(text.data(), maxMessageLength - ellipsis.size(), record.text.begin());
+        std::copy(ellipsis.begin(), ellipsis.end(), end);
+    }
+    if (!threadQueue().push(record)) {
+        delete record.longText;
+        m_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (level >= LogLevel::Warning) {
+        m_urgent.store(true, std::memory_order_release);
+        m_wakeCondition.notify_one();
+    }
+}
+
+void Logger::run()
+{
+    std::vector<Record> batch;
+    std::unique_lock lock(m_wakeMutex);
+    while (m_running) {
+        lock.unlock();
+        writeQueuedRecords(batch);
+        lock.lock();
+        // Notifications without the lock can be missed, the timeout bounds
+        // how late such a line is written
+        m_wakeCondition.wait_for(lock, flushInterval, [this]() {
+            return !m_running || m_urgent.load(std::memory_order_acquire);
+        });
+        m_urgent.store(false, std::memory_order_relaxed);
+    }
+    lock.unlock();
+    writeQueuedRecords(batch);
+}
+
+void Logger::writeQueuedRecords(std::vector<Record>& batch)
+{
+    batch.clear();
+    {
+        std::lock_guard lock(m_queuesMutex);
+        for (const std::unique_ptr<RecordQueue>& queue : m_queues) {
+            Record record;
+            while (queue->pop(record)) {
+                batch.push_back(record);
+            }
+        }
+    }
+    // Stable, so lines of one thread with the same time keep their order
+    std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+        return a.time < b.time;
+    });
+
+    bool wroteErrors = false;
+    bool wroteOutput = false;
+    for (const Record& record : batch) {
+        const bool isError = record.level >= LogLevel::Warning;
+        std::ostream& out = isError ? std::cerr : std::cout;
+        const std::string_view text = record.longText != nullptr
+            ? std::string_view(*record.longText) : std::string_view(record.text.data(), record.length);
+        out << '[' << std::fixed << std::setprecision(3) << std::setw(9) << record.time * 1e-9 << "] "
+            << levelName(record.level) << ": " << text << '\n';
+        delete record.longText;
+        wroteErrors |= isError;
+        wroteOutput |= !isError;
+    }
+    if (const uint64_t dropped = m_droppedRecords.exchange(0, std::memory_order_relaxed); dropped > 0) {
+        std::cerr << "Dropped " << dropped << " log lines" << '\n';
+        wroteErrors = true;
+    }
+    if (wroteOutput) {
+        std::cout.flush();
+    }
+    if (wroteErrors) {
+        std::cerr.flush();
+    }
+}
+
+LogLine::LogLine(LogLevel level)
+    : m_level(level)
+{
+    if (Logger::instance().isEnabled(level)) {
+        m_buffer.emplace(m_text.data(), m_text.size(), level == LogLevel::Error);
+        m_stream.emplace(&*m_buffer);
+    }
+}
+
+LogLine::~LogLine()
+{
+    if (m_buffer) {
+        Logger::instance().write(m_level, m_buffer->text());
+    }
+}
+
+std::string_view LogLine::Buffer::text()
+{
+    if (m_overflow.empty()) {
+        return std::string_view(pbase(), static_cast<size_t>(pptr() - pbase()));
+    }
+    m_overflow.append(pbase(), pptr());
+    setp(pbase(), epptr());
+    return m_overflow;
+}
+
+LogLine::Buffer::int_type LogLine::Buffer::overflow(int_type ch)
+{
+    // A full buffer fails the stream, which ignores the rest of the line
+    if (!m_growable || traits_type::eq_int_type(ch, traits_type::eof())) {
+        return traits_type::eof();
+    }
+    m_overflow.append(pbase(), pptr());
+    m_overflow.push_back(traits_type::to_char_type(ch));
+    setp(pbase(), epptr());
+    return ch;
+}
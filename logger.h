@@ -0,0 +1,131 @@
+#pragma once
+
+#include "spscqueue.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class LogLevel : uint8_t { Debug, Info, Warning, Error };
+
+// Asynchronous logger. Every thread that logs gets its own lock-free queue of
+// fixed-size records; a background thread collects them in time order and
+// writes them out, so logging never waits for the console.
+class Logger
+{
+public:
+    // Longer lines are cut and end in "...". Errors are kept whole, device
+    // errors in particular are often longer than this.
+    static constexpr size_t maxMessageLength = 232;
+
+    static Logger& instance();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+    // Writes out everything queued so far
+    ~Logger();
+
+    void setLevel(LogLevel level) { m_level.store(level, std::memory_order_relaxed); }
+    bool isEnabled(LogLevel level) const { return level >= m_level.load(std::memory_order_relaxed); }
+
+    // Queues a line without blocking. It is dropped if the calling thread's
+    // queue is full.
+    void write(LogLevel level, std::string_view text);
+
+private:
+    struct Record {
+        // Nanoseconds since the logger started
+        int64_t time = 0;
+        LogLevel level = LogLevel::Info;
+        uint8_t length = 0;
+        std::array<char, maxMessageLength> text{};
+        // Errors that do not fit into text, owned by the record until it is
+        // written out
+        std::string *longText = nullptr;
+    };
+    static_assert(maxMessageLength <= UINT8_MAX);
+    using RecordQueue = SpscQueue<Record, 1024>;
+
+    Logger();
+    RecordQueue& threadQueue();
+    void run();
+    void writeQueuedRecords(std::vector<Record>& batch);
+
+    std::atomic<LogLevel> m_level = LogLevel::Info;
+    std::chrono::steady_clock::time_point m_startTime;
+    // Only taken when a thread logs for the first time and by the writer
+    std::mutex m_queuesMutex;
+    std::vector<std::unique_ptr<RecordQueue>> m_queues;
+    std::atomic<uint64_t> m_droppedRecords = 0;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    // Set by warnings and errors, which are written out right away
+    std::atomic<bool> m_urgent = false;
+    bool m_running = true;
+    std::thread m_thread;
+};
+
+// One log line, built with operator<< into a fixed buffer and queued when it
+// goes out of scope. Nothing is formatted when the level is filtered out.
+// Errors continue on the heap once the buffer is full.
+class LogLine
+{
+public:
+    explicit LogLine(LogLevel level);
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+    ~LogLine();
+
+    template <typename T>
+    LogLine& operator<<(const T& value)
+    {
+        if (m_stream) {
+            *m_stream << value;
+        }
+        return *this;
+    }
+
+private:
+    class Buffer : public std::streambuf
+    {
+    public:
+        Buffer(char *begin, size_t size, bool growable)
+            : m_growable(growable)
+        {
+            setp(begin, begin + size);
+        }
+        std::string_view text();
+
+    protected:
+        int_type overflow(int_type ch) override;
+
+    private:
+        bool m_growable;
+        std::string m_overflow;
+    };
+
+    LogLevel m_level;
+    // One more than a record holds, so that the logger sees a line was cut
+    std::array<char, Logger::maxMessageLength + 1> m_text;
+    std::optional<Buffer> m_buffer;
+    std::optional<std::ostream> m_stream;
+};
+
+namespace Log {
+inline LogLine debug() { return LogLine(LogLevel::Debug); }
+inline LogLine info() { return LogLine(LogLevel::Info); }
+inline LogLine warning() { return LogLine(LogLevel::Warning); }
+inline LogLine error() { return LogLine(LogLevel::Error); }
+} // namespace Log
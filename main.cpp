@@ -1,19 +1,135 @@
 #include "application.h"
-#include <iostream>
+#include "logger.h"
 #include <vector>
 #include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
-int main()
+namespace {
+WGPUPresentMode parsePresentMode(std::string_view name)
+{
+    if (name == "fifo")
+        return WGPUPresentMode_Fifo;
+    if (name == "mailbox")
+        return WGPUPresentMode_Mailbox;
+    if (name == "immediate")
+        return WGPUPresentMode_Immediate;
+    throw std::runtime_error("Unknown present mode: " + std::string(name));
+}
+
+LogLevel parseLogLevel(std::string_view name)
+{
+    if (name == "debug")
+        return LogLevel::Debug;
+    if (name == "info")
+        return LogLevel::Info;
+    if (name == "warning")
+        return LogLevel::Warning;
+    if (name == "error")
+        return LogLevel::Error;
+    throw std::runtime_error("Unknown log level: " + std::string(name));
+}
+
+Application::Settings parseArguments(int argc, char *argv[])
+{
+    constexpr std::string_view presentModeOption = "--present-mode=";
+    constexpr std::string_view framesInFlightOption = "--frames-in-flight=";
+    constexpr std::string_view featureTierOption = "--feature-tier=";
+    constexpr std::string_view benchmarkOption = "--benchmark=";
+    constexpr std::string_view recordOption = "--record=";
+    constexpr std::string_view replayOption = "--replay=";
+    constexpr std::string_view replayFpsOption = "--replay-fps=";
+    constexpr std::string_view resourceDirOption = "--resource-dir=";
+    constexpr std::string_view logLevelOption = "--log-level=";
+
+    Application::Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        if (arg.starts_with(presentModeOption)) {
+            settings.presentMode = parsePresentMode(arg.substr(presentModeOption.size()));
+        }
+        else if (arg.starts_with(framesInFlightOption)) {
+            settings.maxFramesInFlight = static_cast<uint32_t>(
+                std::stoul(std::string(arg.substr(framesInFlightOption.size()))));
+        }
+        else if (arg.starts_with(featureTierOption)) {
+            settings.maxFeatureTier = DeviceCapabilities::parseTier(
+                std::string(arg.substr(featureTierOption.size())));
+        }
+        else if (arg.starts_with(benchmarkOption)) {
+            settings.benchmark = std::string(arg.substr(benchmarkOption.size()));
+        }
+        else if (arg.starts_with(recordOption)) {
+            settings.recordPath = std::string(arg.substr(recordOption.size()));
+        }
+        else if (arg.starts_with(replayOption)) {
+            settings.replayPath = std::string(arg.substr(replayOption.size()));
+        }
+        else if (arg.starts_with(replayFpsOption)) {
+            settings.replayFrameRate = std::stod(std::string(arg.substr(replayFpsOption.size())));
+            if (settings.replayFrameRate <= 0.0) {
+                throw std::runtime_error("The replay frame rate must be positive");
+            }
+        }
+        else if (arg.starts_with(resourceDirOption)) {
+            settings.resourceDirectory = std::string(arg.substr(resourceDirOption.size()));
+        }
+        else if (arg.starts_with(logLevelOption)) {
+            Logger::instance().setLevel(parseLogLevel(arg.substr(logLevelOption.size())));
+        }
+        else if (arg == "--continuous") {
+            settings.continuous = true;
+        }
+        else if (arg == "--single-thread") {
+            settings.renderThread = false;
+        }
+        else {
+            throw std::runtime_error("Unknown argument: " + std::string(arg));
+        }
+    }
+    return settings;
+}
+} // namespace
+
+int main(int argc, char *argv[])
 {
     try {
-        Application app;
-        while(app.isRunning()){
-            app.onFrame();
+        Application::Settings settings = parseArguments(argc, argv);
+        std::optional<InputTrace> replayTrace;
+        if (!settings.replayPath.empty()) {
+            replayTrace = InputTrace::load(settings.replayPath);
+            if (replayTrace->launchSettings()) {
+                settings.applyLaunchSettings(*replayTrace->launchSettings());
+            }
+        }
+        Application app(settings);
+        if (!settings.benchmark.empty()) {
+            app.runBenchmark(settings.benchmark);
+        }
+        else if (!settings.replayPath.empty()) {
+            app.runReplay(*replayTrace, settings.replayPath);
+        }
+        else if (settings.renderThread) {
+            app.startRenderThread();
+            while(app.isRunning()){
+                app.waitEvents();
+            }
+            app.stopRenderThread();
+        }
+        else {
+            while(app.isRunning()){
+                app.waitEvents();
+                if (app.needsRedraw()) {
+                    app.onFrame();
+                }
+            }
         }
         app.onFinish();
     }
     catch (const std::exception& e) {
-        std::cerr << e.what() << std::endl;
+        Log::error() << e.what();
         return -1;
     }
 
@@ -0,0 +1,112 @@
+#include "persistentkernel.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+// Must match the constants in persistent.wgsl
+constexpr uint32_t workgroupSize = 64;
+constexpr uint32_t pixelsPerFetch = 8;
+
+constexpr const char *resourceCategory = "Persistent kernel";
+} // namespace
+
+PersistentKernel::PersistentKernel(WGPUDevice device, RenderTargetPool& renderTargets, WGPUBuffer uniformBuffer,
+                                   uint64_t uniformSize, WGPUTextureFormat targetFormat)
+    : m_device(device)
+    , m_renderTargets(renderTargets)
+    , m_uniformBuffer(uniformBuffer)
+    , m_uniformSize(uniformSize)
+{
+    m_shaderModule = GpuShaderModule(Utils::loadShaderModule("shaders/persistent.wgsl", m_device), resourceCategory);
+    if (!m_shaderModule) {
+        throw std::runtime_error("Failed to load the persistent kernel shaders!");
+    }
+
+    m_computePipeline = GpuComputePipeline(
+        Utils::createComputePipeline(m_device, m_shaderModule, "cs_persistent"), resourceCategory);
+    m_presentPipeline = GpuRenderPipeline(
+        Utils::createFullscreenPipeline(m_device, m_shaderModule, "fs_present", targetFormat), resourceCategory);
+
+    WGPUBufferDescriptor bufferDesc{};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.label = "Pixel work queue";
+    bufferDesc.size = sizeof(uint32_t);
+    bufferDesc.mappedAtCreation = false;
+    bufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+    m_queueBuffer = createGpuBuffer(m_device, bufferDesc, resourceCategory);
+}
+
+PersistentKernel::~PersistentKernel()
+{
+    releaseSizedResources();
+}
+
+void PersistentKernel::releaseSizedResources()
+{
+    m_presentBindGroup.reset();
+    m_computeBindGroup.reset();
+    m_renderTargets.release(std::exchange(m_colorTarget, nullptr));
+}
+
+void PersistentKernel::resize(uint32_t width, uint32_t height)
+{
+    m_width = width;
+    m_height = height;
+    if (m_colorTarget != nullptr && m_colorTarget->fits(width, height)) {
+        return;
+    }
+    releaseSizedResources();
+    // Storage textures of the usual BGRA swap chain format need an extension
+    m_colorTarget = m_renderTargets.acquire(WGPUTextureFormat_RGBA8Unorm,
+                                            WGPUTextureUsage_StorageBinding | WGPUTextureUsage_TextureBinding,
+                                            width, height, "Persistent kernel colors");
+
+    m_computeBindGroup = GpuBindGroup(Utils::createBindGroup(m_device, wgpuComputePipelineGetBindGroupLayout(m_computePipeline, 0),
+        std::array{
+            Utils::bufferBindGroupEntry(0, m_uniformBuffer, m_uniformSize),
+            Utils::bufferBindGroupEntry(1, m_queueBuffer, sizeof(uint32_t)),
+            Utils::textureBindGroupEntry(2, m_colorTarget->view),
+        }), resourceCategory);
+    m_presentBindGroup = GpuBindGroup(Utils::createBindGroup(m_device, wgpuRenderPipelineGetBindGroupLayout(m_presentPipeline, 0),
+        std::array{
+            Utils::textureBindGroupEntry(3, m_colorTarget->view),
+        }), resourceCategory);
+}
+
+void PersistentKernel::setWorkgroupCount(uint32_t count)
+{
+    m_workgroupCount = std::max(count, 1u);
+}
+
+void PersistentKernel::encode(WGPUCommandEncoder encoder)
+{
+    wgpuCommandEncoderClearBuffer(encoder, m_queueBuffer, 0, sizeof(uint32_t));
+
+    WGPUComputePassDescriptor computePassDesc{};
+    computePassDesc.nextInChain = nullptr;
+    computePassDesc.label = "Persistent escape time";
+    computePassDesc.timestampWrites = nullptr;
+    WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(encoder, &computePassDesc);
+
+    // No point in launching workgroups which would find the queue empty
+    const uint64_t pixelsPerWorkgroup = uint64_t(workgroupSize) * pixelsPerFetch;
+    const uint64_t neededWorkgroups = (uint64_t(m_width) * m_height + pixelsPerWorkgroup - 1) / pixelsPerWorkgroup;
+    wgpuComputePassEncoderSetPipeline(pass, m_computePipeline);
+    wgpuComputePassEncoderSetBindGroup(pass, 0, m_computeBindGroup, 0, nullptr);
+    wgpuComputePassEncoderDispatchWorkgroups(pass,
+        static_cast<uint32_t>(std::min<uint64_t>(m_workgroupCount, neededWorkgroups)), 1, 1);
+
+    wgpuComputePassEncoderEnd(pass);
+    wgpuComputePassEncoderRelease(pass);
+}
+
+void PersistentKernel::draw(WGPURenderPassEncoder pass)
+{
+    wgpuRenderPassEncoderSetPipeline(pass, m_presentPipeline);
+    wgpuRenderPassEncoderSetBindGroup(pass, 0, m_presentBindGroup, 0, nullptr);
+    wgpuRenderPassEncoderDraw(pass, 3, 1, 0, 0);
+}
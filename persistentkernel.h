@@ -0,0 +1,57 @@
+#pragma once
+
+#include "gpuresource.h"
+#include "rendertargetpool.h"
+
+#include <webgpu/webgpu.h>
+
+#include <cstdint>
+
+// Escape time coloring computed by persistent workgroups that pull pixels
+// from a global atomic work queue, then copied to the target by draw(). Only
+// the f32 kernel has a compute variant.
+class PersistentKernel
+{
+public:
+    // WebGPU does not expose the number of compute units, this is enough
+    // resident workgroups to fill current desktop GPUs
+    static constexpr uint32_t defaultWorkgroupCount = 256;
+
+    PersistentKernel(WGPUDevice device, RenderTargetPool& renderTargets, WGPUBuffer uniformBuffer,
+                     uint64_t uniformSize, WGPUTextureFormat targetFormat);
+    PersistentKernel(const PersistentKernel&) = delete;
+    PersistentKernel& operator=(const PersistentKernel&) = delete;
+    ~PersistentKernel();
+
+    void resize(uint32_t width, uint32_t height);
+
+    // Records the compute pass writing the colors
+    void encode(WGPUCommandEncoder encoder);
+
+    // Copies the colors into the current render pass
+    void draw(WGPURenderPassEncoder pass);
+
+    uint32_t workgroupCount() const { return m_workgroupCount; }
+    void setWorkgroupCount(uint32_t count);
+
+private:
+    void releaseSizedResources();
+
+    WGPUDevice m_device = nullptr;
+    RenderTargetPool& m_renderTargets;
+    WGPUBuffer m_uniformBuffer = nullptr;
+    uint64_t m_uniformSize = 0;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_workgroupCount = defaultWorkgroupCount;
+
+    GpuShaderModule m_shaderModule;
+    GpuComputePipeline m_computePipeline;
+    GpuRenderPipeline m_presentPipeline;
+    GpuBuffer m_queueBuffer;
+
+    // Replaced when a resize leaves the target's size bucket
+    RenderTargetPool::Target *m_colorTarget = nullptr;
+    GpuBindGroup m_computeBindGroup;
+    GpuBindGroup m_presentBindGroup;
+};
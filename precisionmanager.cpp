@@ -0,0 +1,82 @@
+#include "precisionmanager.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Unit roundoff of each representation: 2^-11 for f16, 2^-24 for f32 and
+// 2^-48 for the f32 double-float pairs
+double unitRoundoff(PrecisionManager::Tier tier)
+{
+    switch (tier) {
+    case PrecisionManager::Tier::F16:
+        return std::ldexp(1.0, -11);
+    case PrecisionManager::Tier::F32:
+        return std::ldexp(1.0, -24);
+    case PrecisionManager::Tier::Extended:
+        return std::ldexp(1.0, -48);
+    }
+    return 0.0;
+}
+} // namespace
+
+PrecisionManager::PrecisionManager(bool f16Supported)
+    : m_f16Supported(f16Supported)
+{
+}
+
+bool PrecisionManager::isSupported(Tier tier) const
+{
+    return tier != Tier::F16 || m_f16Supported;
+}
+
+bool PrecisionManager::isPreciseEnough(Tier tier, double relativeStep, double margin) const
+{
+    return relativeStep >= unitRoundoff(tier) * m_safetyFactor * margin;
+}
+
+PrecisionManager::Tier PrecisionManager::update(double pixelStep, double centerMagnitude, float maxIterations)
+{
+    if (m_forcedTier && isSupported(*m_forcedTier)) {
+        m_tier = *m_forcedTier;
+        return m_tier;
+    }
+
+    // Orbits stay within |z| <= 2, so precision is relative to at least that
+    const double relativeStep = pixelStep / std::max(centerMagnitude, 2.0);
+
+    // Move to a more precise tier as soon as the current one is too coarse,
+    // but only return to a cheaper one once well clear of its threshold, so
+    // that zooming around a threshold does not flip between kernels
+    Tier best = Tier::Extended;
+    for (Tier candidate : { Tier::F16, Tier::F32 }) {
+        if (!isSupported(candidate) || (candidate == Tier::F16 && maxIterations > maxF16Iterations)) {
+            continue;
+        }
+        const double margin = candidate < m_tier ? 1.0 + m_hysteresis : 1.0;
+        if (isPreciseEnough(candidate, relativeStep, margin)) {
+            best = candidate;
+            break;
+        }
+    }
+    m_tier = best;
+    return m_tier;
+}
+
+void PrecisionManager::setForcedTier(std::optional<Tier> tier)
+{
+    m_forcedTier = tier;
+}
+
+const char *PrecisionManager::tierName(Tier tier)
+{
+    switch (tier) {
+    case Tier::F16:
+        return "f16";
+    case Tier::F32:
+        return "f32";
+    case Tier::Extended:
+        return "extended (df64)";
+    }
+    return "invalid";
+}
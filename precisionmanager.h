@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+// Chooses the cheapest arithmetic precision that can still resolve adjacent
+// pixels at the current zoom level. f16 is only chosen for short orbits,
+// see maxF16Iterations.
+class PrecisionManager
+{
+public:
+    enum class Tier : uint8_t { F16, F32, Extended };
+    static constexpr int tierCount = 3;
+    // Rounding errors pile up along the orbit whatever the zoom: f16 escape
+    // times differ from f32 on about 0.4% of the pixels of the whole set at
+    // 16 iterations, 1.3% at 32 and 2.4% at 100
+    static constexpr float maxF16Iterations = 16.0F;
+
+    explicit PrecisionManager(bool f16Supported);
+
+    // pixelStep is the distance between two pixel centres in the complex
+    // plane and centerMagnitude the largest coordinate of the view centre
+    Tier update(double pixelStep, double centerMagnitude, float maxIterations);
+
+    Tier tier() const { return m_tier; }
+    bool isSupported(Tier tier) const;
+
+    // Pins a tier regardless of zoom, e.g. for benchmarking
+    void setForcedTier(std::optional<Tier> tier);
+    std::optional<Tier> forcedTier() const { return m_forcedTier; }
+
+    // A tier is only used while the pixel step spans at least this many ulps
+    // of the view coordinates
+    float safetyFactor() const { return m_safetyFactor; }
+    void setSafetyFactor(float factor) { m_safetyFactor = factor; }
+
+    static const char *tierName(Tier tier);
+
+private:
+    bool isPreciseEnough(Tier tier, double relativeStep, double margin) const;
+
+    bool m_f16Supported = false;
+    Tier m_tier = Tier::F32;
+    std::optional<Tier> m_forcedTier;
+    float m_safetyFactor = 4.0F;
+    // Relative margin required before dropping back to a cheaper tier
+    double m_hysteresis = 0.25;
+};
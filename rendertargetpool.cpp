@@ -0,0 +1,82 @@
+#include "rendertargetpool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+constexpr const char *resourceCategory = "Render targets";
+
+uint32_t bucketed(uint32_t size)
+{
+    const uint32_t bucketSize = RenderTargetPool::bucketSize;
+    return (std::max(size, 1u) + bucketSize - 1) / bucketSize * bucketSize;
+}
+} // namespace
+
+bool RenderTargetPool::Target::fits(uint32_t contentWidth, uint32_t contentHeight) const
+{
+    return bucketed(contentWidth) == width && bucketed(contentHeight) == height;
+}
+
+RenderTargetPool::RenderTargetPool(WGPUDevice device)
+    : m_device(device)
+{
+}
+
+RenderTargetPool::Target *RenderTargetPool::acquire(WGPUTextureFormat format, WGPUTextureUsageFlags usage,
+                                                    uint32_t width, uint32_t height, const char *label)
+{
+    // Most recently released first, it is the likeliest to still be warm
+    const auto reusable = std::find_if(m_free.rbegin(), m_free.rend(), [&](const std::unique_ptr<Target>& target) {
+        return target->format == format && target->usage == usage && target->fits(width, height);
+    });
+    if (reusable != m_free.rend()) {
+        ++m_reuses;
+        m_used.push_back(std::move(*reusable));
+        m_free.erase(std::next(reusable).base());
+        return m_used.back().get();
+    }
+
+    auto target = std::make_unique<Target>();
+    target->format = format;
+    target->usage = usage;
+    target->width = bucketed(width);
+    target->height = bucketed(height);
+
+    WGPUTextureDescriptor textureDesc{};
+    textureDesc.nextInChain = nullptr;
+    textureDesc.label = label;
+    textureDesc.usage = usage;
+    textureDesc.dimension = WGPUTextureDimension_2D;
+    textureDesc.size = { target->width, target->height, 1 };
+    textureDesc.format = format;
+    textureDesc.mipLevelCount = 1;
+    textureDesc.sampleCount = 1;
+    textureDesc.viewFormatCount = 0;
+    textureDesc.viewFormats = nullptr;
+    target->texture = createGpuTexture(m_device, textureDesc, resourceCategory);
+    if (!target->texture) {
+        throw std::runtime_error("Failed to create a render target!");
+    }
+    target->view = GpuTextureView(wgpuTextureCreateView(target->texture, nullptr), resourceCategory);
+    ++m_allocations;
+
+    m_used.push_back(std::move(target));
+    return m_used.back().get();
+}
+
+void RenderTargetPool::release(Target *target)
+{
+    const auto it = std::find_if(m_used.begin(), m_used.end(), [&](const std::unique_ptr<Target>& used) {
+        return used.get() == target;
+    });
+    if (it == m_used.end()) {
+        return;
+    }
+    // The GPU may still be reading it, WebGPU orders the next use after that
+    m_free.push_back(std::move(*it));
+    m_used.erase(it);
+    if (m_free.size() > maxFreeTargets) {
+        m_free.erase(m_free.begin());
+    }
+}
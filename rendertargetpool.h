@@ -0,0 +1,55 @@
+#pragma once
+
+#include "gpuresource.h"
+
+#include <webgpu/webgpu.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Offscreen textures shared by the render modes. Sizes are rounded up to
+// buckets, so a resize within the same bucket keeps the texture and the bind
+// groups built on it. Released targets are kept for the next acquire of the
+// same format, usage and bucket.
+class RenderTargetPool
+{
+public:
+    // Both dimensions are rounded up to a multiple of this
+    static constexpr uint32_t bucketSize = 128;
+    // Released targets beyond this are freed, oldest first
+    static constexpr size_t maxFreeTargets = 4;
+
+    struct Target {
+        GpuTexture texture;
+        GpuTextureView view;
+        WGPUTextureFormat format = WGPUTextureFormat_Undefined;
+        WGPUTextureUsageFlags usage = 0;
+        // Allocated size, which the content may only partly cover
+        uint32_t width = 0;
+        uint32_t height = 0;
+
+        // Whether content of this size falls into the target's bucket
+        bool fits(uint32_t contentWidth, uint32_t contentHeight) const;
+    };
+
+    explicit RenderTargetPool(WGPUDevice device);
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    // The target stays valid until it is released
+    Target *acquire(WGPUTextureFormat format, WGPUTextureUsageFlags usage, uint32_t width, uint32_t height,
+                    const char *label);
+    void release(Target *target);
+
+    uint64_t allocationCount() const { return m_allocations; }
+    uint64_t reuseCount() const { return m_reuses; }
+
+private:
+    WGPUDevice m_device = nullptr;
+    std::vector<std::unique_ptr<Target>> m_used;
+    // In release order
+    std::vector<std::unique_ptr<Target>> m_free;
+    uint64_t m_allocations = 0;
+    uint64_t m_reuses = 0;
+};
@@ -0,0 +1,97 @@
+#include "resizemanager.h"
+#include "utils.h"
+
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+constexpr const char *resourceCategory = "Resize";
+} // namespace
+
+ResizeManager::ResizeManager(WGPUDevice device, RenderTargetPool& renderTargets, WGPUBuffer uniformBuffer,
+                             uint64_t uniformSize, WGPUTextureFormat targetFormat, const Size& size)
+    : m_device(device)
+    , m_renderTargets(renderTargets)
+    , m_uniformBuffer(uniformBuffer)
+    , m_uniformSize(uniformSize)
+    , m_targetFormat(targetFormat)
+    , m_current(size)
+{
+    m_shaderModule = GpuShaderModule(Utils::loadShaderModule("shaders/present.wgsl", m_device), resourceCategory);
+    if (!m_shaderModule) {
+        throw std::runtime_error("Failed to load the present shader!");
+    }
+    m_presentPipeline = GpuRenderPipeline(
+        Utils::createFullscreenPipeline(m_device, m_shaderModule, "fs_present", targetFormat), resourceCategory);
+
+    WGPUSamplerDescriptor samplerDesc{};
+    samplerDesc.nextInChain = nullptr;
+    samplerDesc.label = "Scene sampler";
+    samplerDesc.addressModeU = WGPUAddressMode_ClampToEdge;
+    samplerDesc.addressModeV = WGPUAddressMode_ClampToEdge;
+    samplerDesc.addressModeW = WGPUAddressMode_ClampToEdge;
+    samplerDesc.magFilter = WGPUFilterMode_Linear;
+    samplerDesc.minFilter = WGPUFilterMode_Linear;
+    samplerDesc.mipmapFilter = WGPUMipmapFilterMode_Nearest;
+    samplerDesc.lodMinClamp = 0.0F;
+    samplerDesc.lodMaxClamp = 1.0F;
+    samplerDesc.maxAnisotropy = 1;
+    m_sampler = GpuSampler(wgpuDeviceCreateSampler(m_device, &samplerDesc), resourceCategory);
+
+    resizeScene(static_cast<uint32_t>(size.framebufferWidth), static_cast<uint32_t>(size.framebufferHeight));
+}
+
+ResizeManager::~ResizeManager()
+{
+    m_presentBindGroup.reset();
+    m_renderTargets.release(m_scene);
+}
+
+void ResizeManager::request(const Size& size, double time)
+{
+    if (size == m_current) {
+        m_pending.reset();
+        return;
+    }
+    m_pending = size;
+    m_requestTime = time;
+}
+
+std::optional<ResizeManager::Size> ResizeManager::takeSettledSize(double time)
+{
+    if (!m_pending || time - m_requestTime < settleDelay) {
+        return std::nullopt;
+    }
+    const Size size = *std::exchange(m_pending, std::nullopt);
+    if (size.framebufferWidth <= 0 || size.framebufferHeight <= 0) {
+        return std::nullopt;
+    }
+    m_current = size;
+    return size;
+}
+
+void ResizeManager::resizeScene(uint32_t width, uint32_t height)
+{
+    if (m_scene != nullptr && m_scene->fits(width, height)) {
+        return;
+    }
+    m_presentBindGroup.reset();
+    m_renderTargets.release(m_scene);
+    m_scene = m_renderTargets.acquire(m_targetFormat,
+                                      WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_TextureBinding,
+                                      width, height, "Scene");
+    m_presentBindGroup = GpuBindGroup(Utils::createBindGroup(m_device, wgpuRenderPipelineGetBindGroupLayout(m_presentPipeline, 0),
+        std::array{
+            Utils::bufferBindGroupEntry(0, m_uniformBuffer, m_uniformSize),
+            Utils::textureBindGroupEntry(1, m_scene->view),
+            Utils::samplerBindGroupEntry(2, m_sampler),
+        }), resourceCategory);
+}
+
+void ResizeManager::presentScene(WGPURenderPassEncoder pass)
+{
+    wgpuRenderPassEncoderSetPipeline(pass, m_presentPipeline);
+    wgpuRenderPassEncoderSetBindGroup(pass, 0, m_presentBindGroup, 0, nullptr);
+    wgpuRenderPassEncoderDraw(pass, 3, 1, 0, 0);
+}
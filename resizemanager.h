@@ -0,0 +1,69 @@
+#pragma once
+
+#include "gpuresource.h"
+#include "rendertargetpool.h"
+
+#include <webgpu/webgpu.h>
+
+#include <cstdint>
+#include <optional>
+
+// Turns the stream of window resize events into a single resize once the
+// size has stopped changing. Until then frames only present the previous
+// scene scaled to the window, instead of rebuilding the swap chain and the
+// render targets for every intermediate size.
+class ResizeManager
+{
+public:
+    struct Size {
+        int framebufferWidth = 0;
+        int framebufferHeight = 0;
+        int windowWidth = 0;
+        int windowHeight = 0;
+
+        bool operator==(const Size&) const = default;
+    };
+
+    // Seconds without a new size before it is applied
+    static constexpr double settleDelay = 0.1;
+
+    ResizeManager(WGPUDevice device, RenderTargetPool& renderTargets, WGPUBuffer uniformBuffer,
+                  uint64_t uniformSize, WGPUTextureFormat targetFormat, const Size& size);
+    ResizeManager(const ResizeManager&) = delete;
+    ResizeManager& operator=(const ResizeManager&) = delete;
+    ~ResizeManager();
+
+    // Only the newest request is kept; returning to the current size cancels it
+    void request(const Size& size, double time);
+
+    bool isResizing() const { return m_pending.has_value(); }
+
+    // The requested size, once no request came in for settleDelay. Sizes of
+    // a minimized window are dropped.
+    std::optional<Size> takeSettledSize(double time);
+
+    // The scene is rendered into this target, its content covers the window
+    // size given to resizeScene()
+    void resizeScene(uint32_t width, uint32_t height);
+    WGPUTextureView sceneTarget() const { return m_scene->view; }
+
+    // Draws the last scene, without its padding, into the current render pass
+    void presentScene(WGPURenderPassEncoder pass);
+
+private:
+    WGPUDevice m_device = nullptr;
+    RenderTargetPool& m_renderTargets;
+    WGPUBuffer m_uniformBuffer = nullptr;
+    uint64_t m_uniformSize = 0;
+    WGPUTextureFormat m_targetFormat = WGPUTextureFormat_Undefined;
+
+    Size m_current;
+    std::optional<Size> m_pending;
+    double m_requestTime = 0.0;
+
+    GpuShaderModule m_shaderModule;
+    GpuRenderPipeline m_presentPipeline;
+    GpuSampler m_sampler;
+    RenderTargetPool::Target *m_scene = nullptr;
+    GpuBindGroup m_presentBindGroup;
+};
@@ -0,0 +1,64 @@
+#include "resources.h"
+#include "logger.h"
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+
+namespace {
+struct EmbeddedResource {
+    std::string_view path;
+    std::span<const unsigned char> data;
+};
+
+#include "embeddedresources.inc"
+
+std::mutex overrideMutex;
+std::filesystem::path overrideDirectory;
+// Files read from the override directory, kept for the lifetime of the views
+std::map<std::filesystem::path, std::string> overrideFiles;
+
+std::optional<std::string_view> findOverride(std::string_view path)
+{
+    std::lock_guard lock(overrideMutex);
+    if (overrideDirectory.empty()) {
+        return std::nullopt;
+    }
+    const std::filesystem::path filePath = overrideDirectory / path;
+    if (auto it = overrideFiles.find(filePath); it != overrideFiles.end()) {
+        return it->second;
+    }
+
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    std::string contents{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    Log::info() << "Loaded " << path << " from " << filePath;
+    return overrideFiles.emplace(filePath, std::move(contents)).first->second;
+}
+} // namespace
+
+namespace Resources {
+void setOverrideDirectory(const std::filesystem::path& directory)
+{
+    std::lock_guard lock(overrideMutex);
+    overrideDirectory = directory;
+}
+
+std::optional<std::string_view> find(std::string_view path)
+{
+    if (std::optional<std::string_view> contents = findOverride(path)) {
+        return contents;
+    }
+    for (const EmbeddedResource& resource : embeddedResources) {
+        if (resource.path == path) {
+            return std::string_view(reinterpret_cast<const char *>(resource.data.data()), resource.data.size());
+        }
+    }
+    return std::nullopt;
+}
+} // namespace Resources
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+// Shaders and fonts compiled into the binary by cmake/EmbedResources.cmake,
+// looked up by their path relative to the source tree, e.g.
+// "shaders/shader.wgsl".
+namespace Resources {
+// Makes find() prefer files under this directory, so that shaders can be
+// edited without a rebuild. Resources missing there still come from the
+// binary; an empty path turns the override off.
+void setOverrideDirectory(const std::filesystem::path& directory);
+
+// Contents of the resource, followed by a null byte outside the view. The
+// data stays valid until the program exits.
+std::optional<std::string_view> find(std::string_view path);
+} // namespace Resources
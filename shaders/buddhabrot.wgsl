@@ -0,0 +1,164 @@
+// Buddhabrot: density of the orbits of escaping points. Random c values are
+// iterated, and every orbit point of a c that escapes is counted in the pixel
+// it lands on. Counts accumulate over frames and are tone-mapped for display.
+
+struct Params {
+    // Complex coordinate of pixel (0, 0) and the distance between two pixels
+    origin: vec2f,
+    size: vec2u,
+    pixel_step: f32,
+    max_iterations: u32,
+    // Orbits shorter than this are dropped, they only add a uniform haze
+    min_iterations: u32,
+    frame: u32,
+    samples_per_thread: u32,
+    gamma: f32,
+};
+
+const TILE_WIDTH: u32 = 64u;
+const TILE_HEIGHT: u32 = 32u;
+const TILE_SIZE: u32 = TILE_WIDTH * TILE_HEIGHT;
+const ACCUMULATE_WORKGROUP_SIZE: u32 = 64u;
+const REDUCE_WORKGROUP_SIZE: u32 = 256u;
+const REDUCE_ITEMS_PER_THREAD: u32 = 4u;
+
+@group(0) @binding(0) var<uniform> params: Params;
+@group(0) @binding(1) var<storage, read_write> density: array<atomic<u32>>;
+@group(0) @binding(2) var<storage, read_write> maxDensity: atomic<u32>;
+// Same bindings as above, for the passes which only read them
+@group(0) @binding(1) var<storage, read> densityRead: array<u32>;
+@group(0) @binding(2) var<storage, read> maxDensityRead: u32;
+
+// Workgroup memory is zero-initialized
+var<workgroup> tile: array<atomic<u32>, TILE_SIZE>;
+var<workgroup> partialMax: array<u32, REDUCE_WORKGROUP_SIZE>;
+
+fn pcg_hash(value: u32) -> u32 {
+    let state = value * 747796405u + 2891336453u;
+    let word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+fn random_float(state: ptr<function, u32>) -> f32 {
+    *state = pcg_hash(*state);
+    return f32(*state >> 8u) * (1.0 / 16777216.0);
+}
+
+// Points inside the main cardioid or the period-2 bulb never escape
+fn in_main_bulbs(c: vec2f) -> bool {
+    let y2 = c.y * c.y;
+    let q = (c.x - 0.25) * (c.x - 0.25) + y2;
+    let cardioid = q * (q + (c.x - 0.25)) <= 0.25 * y2;
+    let bulb = (c.x + 1.0) * (c.x + 1.0) + y2 <= 0.0625;
+    return cardioid || bulb;
+}
+
+fn escape_iterations(c: vec2f) -> u32 {
+    var z = vec2f(0.0, 0.0);
+    for (var i = 0u; i < params.max_iterations; i++) {
+        z = vec2f(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+        if (dot(z, z) > 4.0) {
+            return i + 1u;
+        }
+    }
+    return params.max_iterations;
+}
+
+// Every workgroup owns a screen tile and samples c inside it. The first orbit
+// points stay close to c, so a good share of the hits land in the tile and are
+// counted in workgroup memory; only the rest go to the global buffer. The tile
+// is merged with one atomic per non-empty pixel at the end.
+@compute @workgroup_size(ACCUMULATE_WORKGROUP_SIZE)
+fn cs_accumulate(@builtin(workgroup_id) workgroupId: vec3u,
+                 @builtin(local_invocation_index) localIndex: u32,
+                 @builtin(num_workgroups) workgroupCount: vec3u) {
+    let tileOrigin = workgroupId.xy * vec2u(TILE_WIDTH, TILE_HEIGHT);
+    let tileExtent = vec2f(vec2u(TILE_WIDTH, TILE_HEIGHT));
+    let workgroupIndex = workgroupId.y * workgroupCount.x + workgroupId.x;
+    var rng = pcg_hash((workgroupIndex * ACCUMULATE_WORKGROUP_SIZE + localIndex) ^ pcg_hash(params.frame));
+
+    for (var sampleIndex = 0u; sampleIndex < params.samples_per_thread; sampleIndex++) {
+        let pixel = vec2f(tileOrigin) + vec2f(random_float(&rng), random_float(&rng)) * tileExtent;
+        let c = params.origin + pixel * params.pixel_step;
+        if (in_main_bulbs(c)) {
+            continue;
+        }
+        let iterations = escape_iterations(c);
+        if (iterations >= params.max_iterations || iterations < params.min_iterations) {
+            continue;
+        }
+
+        // Replay the escaping orbit and count where it goes
+        var z = vec2f(0.0, 0.0);
+        for (var i = 0u; i < iterations; i++) {
+            z = vec2f(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+            let position = (z - params.origin) / params.pixel_step;
+            if (any(position < vec2f(0.0)) || any(position >= vec2f(params.size))) {
+                continue;
+            }
+            let hit = vec2u(position);
+            let tileHit = hit - tileOrigin;
+            if (all(hit >= tileOrigin) && all(tileHit < vec2u(TILE_WIDTH, TILE_HEIGHT))) {
+                atomicAdd(&tile[tileHit.y * TILE_WIDTH + tileHit.x], 1u);
+            }
+            else {
+                atomicAdd(&density[hit.y * params.size.x + hit.x], 1u);
+            }
+        }
+    }
+    workgroupBarrier();
+
+    for (var index = localIndex; index < TILE_SIZE; index += ACCUMULATE_WORKGROUP_SIZE) {
+        let count = atomicLoad(&tile[index]);
+        let pixel = tileOrigin + vec2u(index % TILE_WIDTH, index / TILE_WIDTH);
+        if (count > 0u && all(pixel < params.size)) {
+            atomicAdd(&density[pixel.y * params.size.x + pixel.x], count);
+        }
+    }
+}
+
+// Brightest pixel, for normalizing the tone map: a tree reduction per
+// workgroup, then one global atomic per workgroup
+@compute @workgroup_size(REDUCE_WORKGROUP_SIZE)
+fn cs_max(@builtin(global_invocation_id) id: vec3u,
+          @builtin(local_invocation_index) localIndex: u32) {
+    let pixelCount = params.size.x * params.size.y;
+    var value = 0u;
+    for (var i = 0u; i < REDUCE_ITEMS_PER_THREAD; i++) {
+        let index = id.x * REDUCE_ITEMS_PER_THREAD + i;
+        if (index < pixelCount) {
+            value = max(value, densityRead[index]);
+        }
+    }
+    partialMax[localIndex] = value;
+    workgroupBarrier();
+
+    for (var stride = REDUCE_WORKGROUP_SIZE / 2u; stride > 0u; stride /= 2u) {
+        if (localIndex < stride) {
+            partialMax[localIndex] = max(partialMax[localIndex], partialMax[localIndex + stride]);
+        }
+        workgroupBarrier();
+    }
+    if (localIndex == 0u) {
+        atomicMax(&maxDensity, partialMax[0]);
+    }
+}
+
+@vertex
+fn vs_fullscreen(@builtin(vertex_index) vertexIndex: u32) -> @builtin(position) vec4f {
+    let uv = vec2f(f32((vertexIndex << 1u) & 2u), f32(vertexIndex & 2u));
+    return vec4f(uv * 2.0 - 1.0, 0.0, 1.0);
+}
+
+// Logarithmic tone map, the density spans several orders of magnitude
+@fragment
+fn fs_tonemap(@builtin(position) position: vec4f) -> @location(0) vec4f {
+    let pixel = vec2u(position.xy);
+    let count = f32(densityRead[pixel.y * params.size.x + pixel.x]);
+    if (count == 0.0) {
+        return vec4f(0.0, 0.0, 0.0, 1.0);
+    }
+    let brightest = f32(max(maxDensityRead, 1u));
+    let t = pow(log(1.0 + count) / log(1.0 + brightest), params.gamma);
+    return vec4f(pow(vec3f(t), vec3f(1.3, 1.0, 0.7)), 1.0);
+}
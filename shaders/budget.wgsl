@@ -0,0 +1,94 @@
+// Per-tile iteration budgets, joined to every fractal kernel when its module
+// is built. cs_estimate probes a sparse grid of every tile and stores the
+// iteration count the tile needs. No tile gets less than max_iterations, the
+// probes can miss filaments between them. Tiles that need more share the
+// iterations that the tiles escaping early leave unused.
+//
+// The kernel provides uUniformData and pixel_iterations(), the escape time of
+// a framebuffer position.
+const BUDGET_TILE_SIZE: u32 = 64u;
+const BUDGET_PROBES: u32 = 8u;
+const MAX_BUDGET_TILES: u32 = 16384u;
+// Tiles on the boundary may get up to this multiple of max_iterations
+const BUDGET_BOOST: f32 = 8.0;
+
+@group(0) @binding(1) var<storage, read> tileBudgets: array<u32, MAX_BUDGET_TILES>;
+// Demand above max_iterations, unused iterations below it, maximum demand,
+// boundary tiles and estimated tiles
+@group(0) @binding(2) var<storage, read> budgetStats: array<u32, 5>;
+// Same bindings, for the estimator which writes them
+@group(0) @binding(1) var<storage, read_write> tileDemand: array<u32, MAX_BUDGET_TILES>;
+@group(0) @binding(2) var<storage, read_write> demandStats: array<atomic<u32>, 5>;
+
+var<workgroup> probesInside: atomic<u32>;
+var<workgroup> slowestProbe: atomic<u32>;
+
+fn budget_tile_count() -> vec2u {
+    let size = vec2u(u32(uUniformData.windowWidth), u32(uUniformData.windowHeight));
+    return (size + BUDGET_TILE_SIZE - 1u) / BUDGET_TILE_SIZE;
+}
+
+fn pixel_budget(position: vec4f) -> f32 {
+    let tiles = budget_tile_count();
+    let tile = vec2u(position.xy) / BUDGET_TILE_SIZE;
+    let index = tile.y * tiles.x + tile.x;
+    if (uUniformData.adaptive_budget == 0.0 || uUniformData.julia != 0.0 || index >= MAX_BUDGET_TILES) {
+        return uUniformData.max_iterations;
+    }
+    let boost = f32(tileBudgets[index]) - uUniformData.max_iterations;
+    if (boost <= 0.0) {
+        return uUniformData.max_iterations;
+    }
+    let scale = min(1.0, f32(budgetStats[1]) / f32(max(budgetStats[0], 1u)));
+    return uUniformData.max_iterations + floor(boost * scale);
+}
+
+@compute @workgroup_size(BUDGET_PROBES, BUDGET_PROBES)
+fn cs_estimate(@builtin(workgroup_id) tile: vec3u,
+               @builtin(local_invocation_id) probe: vec3u,
+               @builtin(local_invocation_index) probeIndex: u32) {
+    let cap = uUniformData.max_iterations * BUDGET_BOOST;
+    let spacing = BUDGET_TILE_SIZE / BUDGET_PROBES;
+    let position = vec2f(tile.xy * BUDGET_TILE_SIZE + probe.xy * spacing + spacing / 2u) + 0.5;
+    let i = pixel_iterations(vec4f(position, 0.0, 1.0), cap);
+    if (i >= cap) {
+        atomicAdd(&probesInside, 1u);
+    }
+    else {
+        atomicMax(&slowestProbe, u32(i));
+    }
+    workgroupBarrier();
+
+    if (probeIndex == 0u) {
+        let inside = atomicLoad(&probesInside);
+        // Tiles straddling the boundary need the most iterations
+        var demand = u32(cap);
+        if (inside == 0u) {
+            // Roughly what the tile uses. It still gets max_iterations,
+            // filaments between the probes can need all of them.
+            demand = min(2u * atomicLoad(&slowestProbe) + 32u, u32(cap));
+        }
+        else if (inside == BUDGET_PROBES * BUDGET_PROBES) {
+            // Interior tiles stay black whatever the budget
+            demand = u32(uUniformData.max_iterations);
+        }
+        else {
+            atomicAdd(&demandStats[3], 1u);
+        }
+
+        let tiles = budget_tile_count();
+        let index = tile.y * tiles.x + tile.x;
+        if (index < MAX_BUDGET_TILES) {
+            tileDemand[index] = demand;
+            let maxIterations = u32(uUniformData.max_iterations);
+            if (demand > maxIterations) {
+                atomicAdd(&demandStats[0], demand - maxIterations);
+            }
+            else {
+                atomicAdd(&demandStats[1], maxIterations - demand);
+            }
+            atomicMax(&demandStats[2], demand);
+            atomicAdd(&demandStats[4], 1u);
+        }
+    }
+}
@@ -0,0 +1,113 @@
+// Histogram-equalized coloring: the hue of a pixel is the fraction of escaping
+// pixels that escaped no later than it did, so the palette spreads evenly over
+// the image whatever max_iterations is.
+
+struct Uniforms {
+    offset: vec2f,
+    scale: f32,
+    windowWidth: i32,
+    windowHeight: i32,
+    max_iterations: f32,
+    origin: vec4f,
+    pixel_step: vec2f,
+};
+
+// One bin per iteration count, max_iterations is capped to this by the UI
+const BIN_COUNT: u32 = 1024u;
+const HISTOGRAM_WORKGROUP_SIZE: u32 = 16u;
+const SCAN_WORKGROUP_SIZE: u32 = 256u;
+const BINS_PER_SCAN_THREAD: u32 = BIN_COUNT / SCAN_WORKGROUP_SIZE;
+
+@group(0) @binding(0) var<uniform> uUniformData: Uniforms;
+@group(0) @binding(1) var iterationTexture: texture_2d<f32>;
+@group(0) @binding(2) var<storage, read_write> histogram: array<atomic<u32>, BIN_COUNT>;
+@group(0) @binding(3) var<storage, read_write> cdf: array<f32, BIN_COUNT>;
+// Same binding as cdf, for the colorize pass which only reads it
+@group(0) @binding(3) var<storage, read> cdfRead: array<f32, BIN_COUNT>;
+
+// Workgroup memory is zero-initialized
+var<workgroup> localHistogram: array<atomic<u32>, BIN_COUNT>;
+var<workgroup> partialSums: array<u32, SCAN_WORKGROUP_SIZE>;
+
+// Each workgroup counts its tile into workgroup memory first, so that the
+// global bins only see one atomic per non-empty bin and workgroup
+@compute @workgroup_size(HISTOGRAM_WORKGROUP_SIZE, HISTOGRAM_WORKGROUP_SIZE)
+fn cs_histogram(@builtin(global_invocation_id) id: vec3u,
+                @builtin(local_invocation_index) localIndex: u32) {
+    let size = vec2u(u32(uUniformData.windowWidth), u32(uUniformData.windowHeight));
+    if (all(id.xy < size)) {
+        let iterations = textureLoad(iterationTexture, vec2i(id.xy), 0).r;
+        if (iterations < uUniformData.max_iterations) {
+            atomicAdd(&localHistogram[min(u32(iterations), BIN_COUNT - 1u)], 1u);
+        }
+    }
+    workgroupBarrier();
+
+    for (var binIndex = localIndex; binIndex < BIN_COUNT; binIndex += HISTOGRAM_WORKGROUP_SIZE * HISTOGRAM_WORKGROUP_SIZE) {
+        let count = atomicLoad(&localHistogram[binIndex]);
+        if (count > 0u) {
+            atomicAdd(&histogram[binIndex], count);
+        }
+    }
+}
+
+// Single workgroup prefix sum: every thread reduces a run of bins, the run
+// totals are scanned in workgroup memory (Hillis-Steele), then each thread
+// expands its run back into normalized CDF values
+@compute @workgroup_size(SCAN_WORKGROUP_SIZE)
+fn cs_scan(@builtin(local_invocation_index) localIndex: u32) {
+    let firstBin = localIndex * BINS_PER_SCAN_THREAD;
+    var counts: array<u32, BINS_PER_SCAN_THREAD>;
+    var runTotal = 0u;
+    for (var i = 0u; i < BINS_PER_SCAN_THREAD; i++) {
+        counts[i] = atomicLoad(&histogram[firstBin + i]);
+        runTotal += counts[i];
+    }
+    partialSums[localIndex] = runTotal;
+    workgroupBarrier();
+
+    for (var stride = 1u; stride < SCAN_WORKGROUP_SIZE; stride *= 2u) {
+        var value = partialSums[localIndex];
+        if (localIndex >= stride) {
+            value += partialSums[localIndex - stride];
+        }
+        workgroupBarrier();
+        partialSums[localIndex] = value;
+        workgroupBarrier();
+    }
+
+    let total = f32(max(partialSums[SCAN_WORKGROUP_SIZE - 1u], 1u));
+    var running = partialSums[localIndex] - runTotal;
+    for (var i = 0u; i < BINS_PER_SCAN_THREAD; i++) {
+        running += counts[i];
+        cdf[firstBin + i] = f32(running) / total;
+    }
+}
+
+fn hsv2rgb(c: vec3f) -> vec3f {
+    let K = vec4f(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
+    let p = abs(fract(c.xxx + K.xyz) * 6.0 - K.www);
+
+    let v = vec3f(clamp(p.x - K.x, 0.0, 1.0),
+                clamp(p.y - K.x, 0.0, 1.0),
+                clamp(p.z - K.x, 0.0, 1.0));
+    return c.z * mix(K.xxx, v, c.y);
+}
+
+// Full screen triangle, no vertex buffer needed
+@vertex
+fn vs_fullscreen(@builtin(vertex_index) index: u32) -> @builtin(position) vec4f {
+    let uv = vec2f(f32((index << 1u) & 2u), f32(index & 2u));
+    return vec4f(uv * 2.0 - 1.0, 0.0, 1.0);
+}
+
+@fragment
+fn fs_colorize(@builtin(position) position: vec4f) -> @location(0) vec4f {
+    let iterations = textureLoad(iterationTexture, vec2i(position.xy), 0).r;
+    if (iterations >= uUniformData.max_iterations) {
+        return vec4f(0.0, 0.0, 0.0, 1.0);
+    }
+    // Stop short of a full turn so the first and last bins differ in hue
+    let hue = 0.85 * cdfRead[min(u32(iterations), BIN_COUNT - 1u)];
+    return vec4f(hsv2rgb(vec3f(hue, 1.0, 1.0)), 1.0);
+}
@@ -0,0 +1,122 @@
+// Escape time coloring as a persistent-thread compute kernel. A fixed number
+// of workgroups loops until a global atomic counter runs past the last pixel.
+// Each lane takes a few pixels at a time, and when its pixel escapes it moves
+// on to the next one instead of idling until the slowest lane of its wave is
+// done, as it would in the fragment shader.
+
+struct Uniforms {
+    offset: vec2f,
+    scale: f32,
+    windowWidth: i32,
+    windowHeight: i32,
+    max_iterations: f32,
+    origin: vec4f,
+    pixel_step: vec2f,
+};
+
+const WORKGROUP_SIZE: u32 = 64u;
+// Pixels taken from the queue per atomic, to keep the counter cold
+const PIXELS_PER_FETCH: u32 = 8u;
+// Iterations between two checks whether the lane needs a new pixel
+const ITERATIONS_PER_STEP: u32 = 16u;
+
+@group(0) @binding(0) var<uniform> uUniformData: Uniforms;
+@group(0) @binding(1) var<storage, read_write> workQueue: atomic<u32>;
+@group(0) @binding(2) var outputTexture: texture_storage_2d<rgba8unorm, write>;
+@group(0) @binding(3) var colorTexture: texture_2d<f32>;
+
+fn hsv2rgb(c: vec3f) -> vec3f {
+    let K = vec4f(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
+    let p = abs(fract(c.xxx + K.xyz) * 6.0 - K.www);
+
+    let v = vec3f(clamp(p.x - K.x, 0.0, 1.0),
+                clamp(p.y - K.x, 0.0, 1.0),
+                clamp(p.z - K.x, 0.0, 1.0));
+    return c.z * mix(K.xxx, v, c.y);
+}
+
+// Same coloring as fs_main in shader.wgsl
+fn escape_color(i: f32) -> vec4f {
+    var brightness = 1.0;
+    if (i >= uUniformData.max_iterations) {
+        brightness = 0.0;
+    }
+    return vec4f(hsv2rgb(vec3f(i / uUniformData.max_iterations, 1.0, brightness)), 1.0);
+}
+
+fn inside_bulbs(c: vec2f) -> bool {
+    let c2 = dot(c, c);
+    return 256.0 * c2 * c2 - 96.0 * c2 + 32.0 * c.x - 3.0 < 0.0 ||
+           16.0 * (c2 + 2.0 * c.x + 1.0) - 1.0 < 0.0;
+}
+
+fn pixel_coordinates(pixel: u32) -> vec2u {
+    let width = u32(uUniformData.windowWidth);
+    return vec2u(pixel % width, pixel / width);
+}
+
+@compute @workgroup_size(WORKGROUP_SIZE)
+fn cs_persistent() {
+    let pixelCount = u32(uUniformData.windowWidth) * u32(uUniformData.windowHeight);
+    var next = 0u;
+    var end = 0u;
+    var position = vec2u(0u, 0u);
+    var c = vec2f(0.0, 0.0);
+    var z = vec2f(0.0, 0.0);
+    var i = 0.0;
+    var busy = false;
+
+    loop {
+        if (!busy) {
+            if (next == end) {
+                next = atomicAdd(&workQueue, PIXELS_PER_FETCH);
+                if (next >= pixelCount) {
+                    break;
+                }
+                end = min(next + PIXELS_PER_FETCH, pixelCount);
+            }
+            position = pixel_coordinates(next);
+            next++;
+            // Pixel centers, like the fragment shader's position
+            let center = vec2f(position) + 0.5;
+            c = vec2f(uUniformData.origin.x + center.x * uUniformData.pixel_step.x,
+                      uUniformData.origin.z - center.y * uUniformData.pixel_step.x);
+            if (inside_bulbs(c)) {
+                textureStore(outputTexture, position, escape_color(uUniformData.max_iterations));
+                continue;
+            }
+            z = vec2f(0.0, 0.0);
+            i = 0.0;
+            busy = true;
+        }
+
+        for (var iteration = 0u; iteration < ITERATIONS_PER_STEP; iteration++) {
+            if (i >= uUniformData.max_iterations) {
+                busy = false;
+                break;
+            }
+            let zxx = z.x * z.x;
+            let zyy = z.y * z.y;
+            z = vec2f(zxx - zyy, 2.0 * z.x * z.y) + c;
+            if (zxx + zyy > 4.0) {
+                busy = false;
+                break;
+            }
+            i = i + 1.0;
+        }
+        if (!busy) {
+            textureStore(outputTexture, position, escape_color(i));
+        }
+    }
+}
+
+@vertex
+fn vs_fullscreen(@builtin(vertex_index) vertexIndex: u32) -> @builtin(position) vec4f {
+    let uv = vec2f(f32((vertexIndex << 1u) & 2u), f32(vertexIndex & 2u));
+    return vec4f(uv * 2.0 - 1.0, 0.0, 1.0);
+}
+
+@fragment
+fn fs_present(@builtin(position) position: vec4f) -> @location(0) vec4f {
+    return textureLoad(colorTexture, vec2i(position.xy), 0);
+}
@@ -0,0 +1,40 @@
+// Copies the rendered scene to the swap chain. Pooled render targets are
+// padded to 128 px buckets, so the scene only covers the top left of its
+// target and the texture coordinates are scaled to that part. The swap chain
+// keeps the scene's size until a resize settles; until then the presentation
+// engine stretches it to the window.
+
+struct Uniforms {
+    offset: vec2f,
+    scale: f32,
+    windowWidth: i32,
+    windowHeight: i32,
+    max_iterations: f32,
+    origin: vec4f,
+    pixel_step: vec2f,
+};
+
+@group(0) @binding(0) var<uniform> uUniformData: Uniforms;
+@group(0) @binding(1) var sceneTexture: texture_2d<f32>;
+@group(0) @binding(2) var sceneSampler: sampler;
+
+struct VertexOutput {
+    @builtin(position) position: vec4f,
+    @location(0) texcoord: vec2f,
+};
+
+@vertex
+fn vs_fullscreen(@builtin(vertex_index) vertexIndex: u32) -> VertexOutput {
+    let uv = vec2f(f32((vertexIndex << 1u) & 2u), f32(vertexIndex & 2u));
+    // Size the scene was rendered at, which only changes once a resize settles
+    let sceneSize = vec2f(f32(uUniformData.windowWidth), f32(uUniformData.windowHeight));
+    var output: VertexOutput;
+    output.position = vec4f(uv * 2.0 - 1.0, 0.0, 1.0);
+    output.texcoord = vec2f(uv.x, 1.0 - uv.y) * sceneSize / vec2f(textureDimensions(sceneTexture));
+    return output;
+}
+
+@fragment
+fn fs_present(input: VertexOutput) -> @location(0) vec4f {
+    return textureSample(sceneTexture, sceneSampler, input.texcoord);
+}
@@ -4,6 +4,15 @@ struct Uniforms {
     windowWidth: i32,
     windowHeight: i32,
     max_iterations: f32,
+    // Julia set parameter, used when julia is non-zero
+    julia_c: vec2f,
+    // View origin (x_hi, x_lo, y_hi, y_lo) and complex plane units per pixel
+    // (hi, lo), as double-floats so that every precision variant shares them
+    origin: vec4f,
+    pixel_step: vec2f,
+    julia: f32,
+    // Per-tile budgets from cs_estimate instead of max_iterations
+    adaptive_budget: f32,
 };
 
 struct VertexInput {
@@ -23,10 +32,10 @@ fn vs_main(in: VertexInput) -> VertexOutput {
     return out;
 }
 
-fn mandlebrot_iterations(c: vec2f) -> f32 {
-    var z = vec2f(0.0, 0.0);
+fn escape_iterations(start: vec2f, c: vec2f, max_iterations: f32) -> f32 {
+    var z = start;
     var i: f32 = 0;
-    while (i < uUniformData.max_iterations) {
+    while (i < max_iterations) {
         let zxx = z.x * z.x;
         let zyy = z.y * z.y;
         z = vec2f(zxx - zyy, 2.0 * z.x * z.y) + c;
@@ -48,39 +57,67 @@ fn hsv2rgb(c: vec3f) -> vec3f {
     return c.z * mix(K.xxx, v, c.y);
 }
 
-fn location_color(c: vec2f) -> vec3f {
+fn location_iterations(c: vec2f, max_iterations: f32) -> f32 {
+    if (uUniformData.julia != 0.0) {
+        return escape_iterations(c, uUniformData.julia_c, max_iterations);
+    }
+
     // skip computation inside bulbs
     // see https://iquilezles.org/articles/mset1bulb
     // see https://iquilezles.org/articles/mset2bulb
     let c2 = dot(c, c);
     if( 256.0*c2*c2 - 96.0*c2 + 32.0*c.x - 3.0 < 0.0 ){
-        return vec3f(0.0, 0.0, 0.0);
+        return max_iterations;
     }
     if( 16.0*(c2+2.0*c.x+1.0) - 1.0 < 0.0 ){
-        return vec3f(0.0, 0.0, 0.0);
+        return max_iterations;
     }
 
-    var i: f32 = mandlebrot_iterations(c);
+    return escape_iterations(vec2f(0.0, 0.0), c, max_iterations);
+}
 
+fn location_color(c: vec2f, max_iterations: f32) -> vec3f {
+    var i: f32 = location_iterations(c, max_iterations);
+
+    // Relative to the global limit, so that tiles with different budgets
+    // share one palette
     let iterations = i / uUniformData.max_iterations;
 
     var brightness = 1.0;
 
-    if(i == uUniformData.max_iterations) {
+    if(i >= max_iterations) {
         brightness = 0.0;
     }
 
     return hsv2rgb(vec3f(iterations, 1.0, brightness));
 }
 
+fn pixel_location(position: vec4f) -> vec2f {
+    let cx = uUniformData.origin.x + position.x * uUniformData.pixel_step.x;
+    let cy = uUniformData.origin.z - position.y * uUniformData.pixel_step.x;
+    return vec2f(cx, cy);
+}
 
 @fragment
 fn fs_main(in: VertexOutput) -> @location(0) vec4f{
-    let largest_dim = max(f32(uUniformData.windowWidth), f32(uUniformData.windowHeight));
-    let scale_factor = 5 / uUniformData.scale;
-    let cx = ((in.position.x - uUniformData.offset.x)/ largest_dim - 0.5) * scale_factor;
-    let cy = ((in.position.y - uUniformData.offset.y)/ largest_dim - 0.35) * scale_factor;
-    let color = location_color(vec2f(cx, -cy));
+    let color = location_color(pixel_location(in.position), pixel_budget(in.position));
 
     return vec4f(color, 1.0);
 }
+
+// Raw escape time, consumed by the histogram coloring passes
+@fragment
+fn fs_iterations(in: VertexOutput) -> @location(0) vec4f {
+    // The histogram only has bins below max_iterations, so boosted tiles are
+    // capped there; otherwise their extra escapes would be counted as inside
+    let budget = min(pixel_budget(in.position), uUniformData.max_iterations);
+    let i = location_iterations(pixel_location(in.position), budget);
+    // Pixels that used up their tile's budget count as inside the set
+    return vec4f(select(i, uUniformData.max_iterations, i >= budget), 0.0, 0.0, 1.0);
+}
+
+// Escape time of a framebuffer position, for the iteration budget in
+// shaders/budget.wgsl, which is joined to this module
+fn pixel_iterations(position: vec4f, max_iterations: f32) -> f32 {
+    return location_iterations(pixel_location(position), max_iterations);
+}
@@ -0,0 +1,173 @@
+struct Uniforms {
+    offset: vec2f,
+    scale: f32,
+    windowWidth: i32,
+    windowHeight: i32,
+    max_iterations: f32,
+    // View origin (x_hi, x_lo, y_hi, y_lo) and complex plane units per pixel
+    // (hi, lo), as double-floats so that every precision variant shares them
+    origin: vec4f,
+    pixel_step: vec2f,
+    // Only the f32 kernel draws Julia sets
+    julia: f32,
+    // Per-tile budgets from cs_estimate instead of max_iterations
+    adaptive_budget: f32,
+};
+
+struct VertexInput {
+    @location(0) position: vec2f,
+};
+
+struct VertexOutput {
+    @builtin(position) position: vec4f,
+};
+
+@group(0) @binding(0) var<uniform> uUniformData: Uniforms;
+
+@vertex
+fn vs_main(in: VertexInput) -> VertexOutput {
+    var out: VertexOutput;
+    out.position = vec4f(in.position, 0.0, 1.0);
+    return out;
+}
+
+// Double-float ("df64") arithmetic: a value is the unevaluated sum hi + lo of
+// two f32, giving roughly 48 bits of mantissa.
+// See Thall, "Extended-Precision Floating-Point Numbers for GPU Computation".
+fn two_sum(a: f32, b: f32) -> vec2f {
+    let s = a + b;
+    let v = s - a;
+    let e = (a - (s - v)) + (b - v);
+    return vec2f(s, e);
+}
+
+fn quick_two_sum(a: f32, b: f32) -> vec2f {
+    let s = a + b;
+    let e = b - (s - a);
+    return vec2f(s, e);
+}
+
+fn df_split(a: f32) -> vec2f {
+    // 2^12 + 1
+    let t = 4097.0 * a;
+    let hi = t - (t - a);
+    return vec2f(hi, a - hi);
+}
+
+fn two_prod(a: f32, b: f32) -> vec2f {
+    let p = a * b;
+    let a_parts = df_split(a);
+    let b_parts = df_split(b);
+    let e = ((a_parts.x * b_parts.x - p) + a_parts.x * b_parts.y + a_parts.y * b_parts.x) + a_parts.y * b_parts.y;
+    return vec2f(p, e);
+}
+
+fn df_add(a: vec2f, b: vec2f) -> vec2f {
+    var s = two_sum(a.x, b.x);
+    let t = two_sum(a.y, b.y);
+    s.y += t.x;
+    s = quick_two_sum(s.x, s.y);
+    s.y += t.y;
+    return quick_two_sum(s.x, s.y);
+}
+
+fn df_mul(a: vec2f, b: vec2f) -> vec2f {
+    var p = two_prod(a.x, b.x);
+    p.y += a.x * b.y + a.y * b.x;
+    return quick_two_sum(p.x, p.y);
+}
+
+fn mandlebrot_iterations_df(cx: vec2f, cy: vec2f, max_iterations: f32) -> f32 {
+    var zx = vec2f(0.0, 0.0);
+    var zy = vec2f(0.0, 0.0);
+    var i: f32 = 0;
+    while (i < max_iterations) {
+        let zxx = df_mul(zx, zx);
+        let zyy = df_mul(zy, zy);
+        if (zxx.x + zyy.x > 4.0) {
+            break;
+        }
+        // Doubling a double-float is exact
+        let zxy = df_mul(zx, zy) * 2.0;
+        zx = df_add(df_add(zxx, -zyy), cx);
+        zy = df_add(zxy, cy);
+        i = i + 1.0;
+    }
+    return i;
+}
+
+fn hsv2rgb(c: vec3f) -> vec3f {
+    let K = vec4f(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
+    let p = abs(fract(c.xxx + K.xyz) * 6.0 - K.www);
+
+    let v = vec3f(clamp(p.x - K.x, 0.0, 1.0),
+                clamp(p.y - K.x, 0.0, 1.0),
+                clamp(p.z - K.x, 0.0, 1.0));
+    return c.z * mix(K.xxx, v, c.y);
+}
+
+fn location_iterations(cx: vec2f, cy: vec2f, max_iterations: f32) -> f32 {
+    let c = vec2f(cx.x, cy.x);
+    // skip computation inside bulbs
+    // see https://iquilezles.org/articles/mset1bulb
+    // see https://iquilezles.org/articles/mset2bulb
+    let c2 = dot(c, c);
+    if( 256.0*c2*c2 - 96.0*c2 + 32.0*c.x - 3.0 < 0.0 ){
+        return max_iterations;
+    }
+    if( 16.0*(c2+2.0*c.x+1.0) - 1.0 < 0.0 ){
+        return max_iterations;
+    }
+
+    return mandlebrot_iterations_df(cx, cy, max_iterations);
+}
+
+fn location_color(cx: vec2f, cy: vec2f, max_iterations: f32) -> vec3f {
+    var i: f32 = location_iterations(cx, cy, max_iterations);
+
+    // Relative to the global limit, so that tiles with different budgets
+    // share one palette
+    let iterations = i / uUniformData.max_iterations;
+
+    var brightness = 1.0;
+
+    if(i >= max_iterations) {
+        brightness = 0.0;
+    }
+
+    return hsv2rgb(vec3f(iterations, 1.0, brightness));
+}
+
+// Complex coordinate of a pixel as double-floats: (x_hi, x_lo, y_hi, y_lo)
+fn pixel_location(position: vec4f) -> vec4f {
+    let cx = df_add(uUniformData.origin.xy, df_mul(uUniformData.pixel_step, vec2f(position.x, 0.0)));
+    let cy = df_add(uUniformData.origin.zw, -df_mul(uUniformData.pixel_step, vec2f(position.y, 0.0)));
+    return vec4f(cx, cy);
+}
+
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4f{
+    let c = pixel_location(in.position);
+    let color = location_color(c.xy, c.zw, pixel_budget(in.position));
+
+    return vec4f(color, 1.0);
+}
+
+// Raw escape time, consumed by the histogram coloring passes
+@fragment
+fn fs_iterations(in: VertexOutput) -> @location(0) vec4f {
+    let c = pixel_location(in.position);
+    // The histogram only has bins below max_iterations, so boosted tiles are
+    // capped there; otherwise their extra escapes would be counted as inside
+    let budget = min(pixel_budget(in.position), uUniformData.max_iterations);
+    let i = location_iterations(c.xy, c.zw, budget);
+    // Pixels that used up their tile's budget count as inside the set
+    return vec4f(select(i, uUniformData.max_iterations, i >= budget), 0.0, 0.0, 1.0);
+}
+
+// Escape time of a framebuffer position, for the iteration budget in
+// shaders/budget.wgsl, which is joined to this module
+fn pixel_iterations(position: vec4f, max_iterations: f32) -> f32 {
+    let c = pixel_location(position);
+    return location_iterations(c.xy, c.zw, max_iterations);
+}
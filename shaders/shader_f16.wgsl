@@ -0,0 +1,123 @@
+enable f16;
+
+struct Uniforms {
+    offset: vec2f,
+    scale: f32,
+    windowWidth: i32,
+    windowHeight: i32,
+    max_iterations: f32,
+    // View origin (x_hi, x_lo, y_hi, y_lo) and complex plane units per pixel
+    // (hi, lo), as double-floats so that every precision variant shares them
+    origin: vec4f,
+    pixel_step: vec2f,
+    // Only the f32 kernel draws Julia sets
+    julia: f32,
+    // Per-tile budgets from cs_estimate instead of max_iterations
+    adaptive_budget: f32,
+};
+
+struct VertexInput {
+    @location(0) position: vec2f,
+};
+
+struct VertexOutput {
+    @builtin(position) position: vec4f,
+};
+
+@group(0) @binding(0) var<uniform> uUniformData: Uniforms;
+
+@vertex
+fn vs_main(in: VertexInput) -> VertexOutput {
+    var out: VertexOutput;
+    out.position = vec4f(in.position, 0.0, 1.0);
+    return out;
+}
+
+// Half precision orbit: twice the ALU rate on most GPUs, only accurate
+// enough for overview zoom levels
+fn mandlebrot_iterations(c: vec2f, max_iterations: f32) -> f32 {
+    let ch = vec2<f16>(c);
+    var z = vec2<f16>(0.0h, 0.0h);
+    var i: f32 = 0;
+    while (i < max_iterations) {
+        let zxx = z.x * z.x;
+        let zyy = z.y * z.y;
+        if (zxx + zyy > 4.0h) {
+            break;
+        }
+        z = vec2<f16>(zxx - zyy, 2.0h * z.x * z.y) + ch;
+        i = i + 1.0;
+    }
+    return i;
+}
+
+fn hsv2rgb(c: vec3f) -> vec3f {
+    let K = vec4f(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
+    let p = abs(fract(c.xxx + K.xyz) * 6.0 - K.www);
+
+    let v = vec3f(clamp(p.x - K.x, 0.0, 1.0),
+                clamp(p.y - K.x, 0.0, 1.0),
+                clamp(p.z - K.x, 0.0, 1.0));
+    return c.z * mix(K.xxx, v, c.y);
+}
+
+fn location_iterations(c: vec2f, max_iterations: f32) -> f32 {
+    // skip computation inside bulbs
+    // see https://iquilezles.org/articles/mset1bulb
+    // see https://iquilezles.org/articles/mset2bulb
+    let c2 = dot(c, c);
+    if( 256.0*c2*c2 - 96.0*c2 + 32.0*c.x - 3.0 < 0.0 ){
+        return max_iterations;
+    }
+    if( 16.0*(c2+2.0*c.x+1.0) - 1.0 < 0.0 ){
+        return max_iterations;
+    }
+
+    return mandlebrot_iterations(c, max_iterations);
+}
+
+fn location_color(c: vec2f, max_iterations: f32) -> vec3f {
+    var i: f32 = location_iterations(c, max_iterations);
+
+    // Relative to the global limit, so that tiles with different budgets
+    // share one palette
+    let iterations = i / uUniformData.max_iterations;
+
+    var brightness = 1.0;
+
+    if(i >= max_iterations) {
+        brightness = 0.0;
+    }
+
+    return hsv2rgb(vec3f(iterations, 1.0, brightness));
+}
+
+fn pixel_location(position: vec4f) -> vec2f {
+    let cx = uUniformData.origin.x + position.x * uUniformData.pixel_step.x;
+    let cy = uUniformData.origin.z - position.y * uUniformData.pixel_step.x;
+    return vec2f(cx, cy);
+}
+
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4f{
+    let color = location_color(pixel_location(in.position), pixel_budget(in.position));
+
+    return vec4f(color, 1.0);
+}
+
+// Raw escape time, consumed by the histogram coloring passes
+@fragment
+fn fs_iterations(in: VertexOutput) -> @location(0) vec4f {
+    // The histogram only has bins below max_iterations, so boosted tiles are
+    // capped there; otherwise their extra escapes would be counted as inside
+    let budget = min(pixel_budget(in.position), uUniformData.max_iterations);
+    let i = location_iterations(pixel_location(in.position), budget);
+    // Pixels that used up their tile's budget count as inside the set
+    return vec4f(select(i, uUniformData.max_iterations, i >= budget), 0.0, 0.0, 1.0);
+}
+
+// Escape time of a framebuffer position, for the iteration budget in
+// shaders/budget.wgsl, which is joined to this module
+fn pixel_iterations(position: vec4f, max_iterations: f32) -> f32 {
+    return location_iterations(pixel_location(position), max_iterations);
+}
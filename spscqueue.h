@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free single-producer/single-consumer ring buffer.
+// push() must only be called from one thread and pop() from one other thread.
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+public:
+    // Returns false (and drops the value) if the queue is full
+    bool push(const T& value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail == Capacity) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail == Capacity) {
+                return false;
+            }
+        }
+        m_buffer[head & mask] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead) {
+                return false;
+            }
+        }
+        value = m_buffer[tail & mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Only a hint when called from the producer side
+    bool empty() const
+    {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t mask = Capacity - 1;
+    static constexpr size_t cacheLineSize = 64;
+
+    // Producer and consumer indices live on separate cache lines, each next to
+    // the cached copy of the other side's index to avoid needless sharing
+    alignas(cacheLineSize) std::atomic<size_t> m_head = 0;
+    size_t m_cachedTail = 0;
+    alignas(cacheLineSize) std::atomic<size_t> m_tail = 0;
+    size_t m_cachedHead = 0;
+    alignas(cacheLineSize) std::array<T, Capacity> m_buffer{};
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer "latest value" channel.
+// The producer never waits for the consumer and the consumer always sees the
+// most recently published value; intermediate values may be skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    explicit TripleBuffer(const T& initial)
+    {
+        m_buffers.fill(initial);
+    }
+
+    // Producer side
+    void publish(const T& value)
+    {
+        m_buffers[m_writeIndex] = value;
+        const uint8_t previous = m_middle.exchange(m_writeIndex | freshBit, std::memory_order_acq_rel);
+        m_writeIndex = previous & indexMask;
+    }
+
+    // Consumer side: swaps in the newest value, returns false if there was none
+    bool update()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & freshBit) == 0) {
+            return false;
+        }
+        const uint8_t previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+        m_readIndex = previous & indexMask;
+        return true;
+    }
+
+    bool hasUpdate() const
+    {
+        return (m_middle.load(std::memory_order_acquire) & freshBit) != 0;
+    }
+
+    const T& read() const
+    {
+        return m_buffers[m_readIndex];
+    }
+
+private:
+    static constexpr uint8_t indexMask = 0x3;
+    static constexpr uint8_t freshBit = 0x4;
+
+    std::array<T, 3> m_buffers{};
+    uint8_t m_writeIndex = 0;
+    std::atomic<uint8_t> m_middle = 1;
+    uint8_t m_readIndex = 2;
+};
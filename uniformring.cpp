@@ -0,0 +1,59 @@
+#include "uniformring.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+// Largest alignment WebGPU allows an implementation to require
+constexpr uint32_t maxOffsetAlignment = 256;
+} // namespace
+
+UniformRing::UniformRing(WGPUDevice device, WGPUQueue queue, uint64_t elementSize,
+                         uint32_t elementsPerFrame, uint32_t frameCount, uint32_t offsetAlignment)
+    : m_queue(queue)
+    , m_elementSize(elementSize)
+    , m_elementsPerFrame(elementsPerFrame)
+    , m_frameCount(frameCount)
+{
+    // Unset limits read back as all ones
+    if (offsetAlignment == 0 || offsetAlignment > maxOffsetAlignment) {
+        offsetAlignment = maxOffsetAlignment;
+    }
+    m_stride = (elementSize + offsetAlignment - 1) / offsetAlignment * offsetAlignment;
+    m_staging.resize(m_stride * m_elementsPerFrame);
+
+    WGPUBufferDescriptor bufferDesc{};
+    bufferDesc.nextInChain = nullptr;
+    bufferDesc.label = "Uniform ring";
+    bufferDesc.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Uniform;
+    bufferDesc.size = m_stride * m_elementsPerFrame * m_frameCount;
+    bufferDesc.mappedAtCreation = false;
+    m_buffer = createGpuBuffer(device, bufferDesc, "Uniforms");
+}
+
+void UniformRing::beginFrame()
+{
+    m_frame = (m_frame + 1) % m_frameCount;
+    m_pushed = 0;
+}
+
+uint32_t UniformRing::push(const void *data)
+{
+    if (m_pushed == m_elementsPerFrame) {
+        throw std::runtime_error("Uniform ring frame region is full!");
+    }
+    std::memcpy(m_staging.data() + m_pushed * m_stride, data, m_elementSize);
+    const uint64_t offset = (uint64_t(m_frame) * m_elementsPerFrame + m_pushed) * m_stride;
+    ++m_pushed;
+    return static_cast<uint32_t>(offset);
+}
+
+void UniformRing::flush()
+{
+    if (m_pushed == 0) {
+        return;
+    }
+    const uint64_t frameOffset = uint64_t(m_frame) * m_elementsPerFrame * m_stride;
+    const uint64_t size = (m_pushed - 1) * m_stride + m_elementSize;
+    wgpuQueueWriteBuffer(m_queue, m_buffer, frameOffset, m_staging.data(), size);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "gpuresource.h"
+
+#include <webgpu/webgpu.h>
+
+#include <cstdint>
+#include <vector>
+
+// Per-draw uniform blocks packed into one buffer and selected with dynamic
+// bind group offsets. Each frame fills its own region of the ring, so a frame
+// still in flight never has its uniforms overwritten, and all blocks of a
+// frame are uploaded with a single queue write.
+class UniformRing
+{
+public:
+    UniformRing(WGPUDevice device, WGPUQueue queue, uint64_t elementSize,
+                uint32_t elementsPerFrame, uint32_t frameCount, uint32_t offsetAlignment);
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    WGPUBuffer buffer() const { return m_buffer; }
+    uint64_t elementSize() const { return m_elementSize; }
+
+    // Moves on to the next frame's region
+    void beginFrame();
+
+    // Stages one block and returns its dynamic offset
+    uint32_t push(const void *data);
+
+    // Uploads the blocks pushed since beginFrame()
+    void flush();
+
+private:
+    WGPUQueue m_queue = nullptr;
+    GpuBuffer m_buffer;
+    uint64_t m_elementSize = 0;
+    uint64_t m_stride = 0;
+    uint32_t m_elementsPerFrame = 0;
+    uint32_t m_frameCount = 0;
+    uint32_t m_frame = 0;
+    uint32_t m_pushed = 0;
+    std::vector<uint8_t> m_staging;
+};
@@ -1,7 +1,11 @@
 #include "utils.h"
-#include <iostream>
+#include "logger.h"
+#include "resources.h"
 #include <cassert>
-#include <fstream>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
 #include <vector>
 
 
@@ -69,7 +73,7 @@ WGPUAdapter requestAdapter(WGPUInstance instance,
     if (status == WGPURequestAdapterStatus_Success) {
       userData.adapter = adapter;
     } else {
-      std::cout << "Could not get WebGPU adapter: " << message << std::endl;
+      Log::error() << "Could not get WebGPU adapter: " << message;
     }
     userData.requestEnded = true;
   };
@@ -97,7 +101,7 @@ WGPUDevice requestDevice(WGPUAdapter adapter, const WGPUDeviceDescriptor *descri
         if (status == WGPURequestDeviceStatus_Success) {
             userData.device = device;
         } else {
-            std::cout << "Could not get WebGPU device: " << message << std::endl;
+            Log::error() << "Could not get WebGPU device: " << message;
         }
         userData.requestEnded = true;
     };
@@ -108,37 +112,68 @@ WGPUDevice requestDevice(WGPUAdapter adapter, const WGPUDeviceDescriptor *descri
     // Get adapter properties
     WGPUAdapterProperties properties{};
     wgpuAdapterGetProperties(adapter, &properties);
-    std::cout << "Adapter name: " << properties.name << std::endl;
-    std::cout << "Adapter vendor: " << properties.vendorName << std::endl;
-    std::cout << "Adapter device id: " << properties.deviceID << std::endl;
-    std::cout << "Adapter driver version: " << properties.driverDescription << std::endl;
-    std::cout << "Adapter type: " << adapterTypeToString(properties.adapterType) << std::endl;
-    std::cout << "Adapter backend type: " << adapterBackendToString(properties.backendType) << std::endl;
-    std::cout << "Adapter compatibility mode: " << properties.compatibilityMode << std::endl;
+    Log::info() << "Adapter name: " << properties.name;
+    Log::info() << "Adapter vendor: " << properties.vendorName;
+    Log::info() << "Adapter device id: " << properties.deviceID;
+    Log::info() << "Adapter driver version: " << properties.driverDescription;
+    Log::info() << "Adapter type: " << adapterTypeToString(properties.adapterType);
+    Log::info() << "Adapter backend type: " << adapterBackendToString(properties.backendType);
+    Log::info() << "Adapter compatibility mode: " << properties.compatibilityMode;
     return userData.device;
 }
 
-WGPUShaderModule loadShaderModule(const std::filesystem::path& filePath, WGPUDevice device)
+WGPUShaderModule loadShaderModule(std::string_view resourcePath, WGPUDevice device,
+                                  std::span<const std::string_view> libraryPaths)
 {
-    std::ifstream file(filePath);
-    if(!file.is_open()){
-        std::cerr << "Could not open file: " << filePath << std::endl;
+    const std::optional<std::string_view> source = Resources::find(resourcePath);
+    if(!source){
+        Log::error() << "Could not find shader: " << resourcePath;
         return nullptr;
     }
-    file.seekg(0, std::ios::end);
-    std::string buffer(file.tellg(), ' ');
-    file.seekg(0);
-    file.read(buffer.data(), buffer.size());
+    std::string joinedSource;
+    if (!libraryPaths.empty()) {
+        joinedSource = *source;
+        for (std::string_view libraryPath : libraryPaths) {
+            const std::optional<std::string_view> library = Resources::find(libraryPath);
+            if (!library) {
+                Log::error() << "Could not find shader: " << libraryPath;
+                return nullptr;
+            }
+            joinedSource.append("\n").append(*library);
+        }
+    }
 
     WGPUShaderModuleWGSLDescriptor shaderCodeDesc = {};
     shaderCodeDesc.chain.next = nullptr;
     shaderCodeDesc.chain.sType = WGPUSType_ShaderModuleWGSLDescriptor;
-    shaderCodeDesc.code = buffer.data();
+    // Resources are null terminated
+    shaderCodeDesc.code = libraryPaths.empty() ? source->data() : joinedSource.c_str();
     WGPUShaderModuleDescriptor shaderDesc{};
     shaderDesc.nextInChain = &shaderCodeDesc.chain;
     return wgpuDeviceCreateShaderModule(device, &shaderDesc);
 }
 
+bool mapBufferAndWait(WGPUDevice device, WGPUBuffer buffer, WGPUMapModeFlags mode, uint64_t size)
+{
+    struct MapResult {
+        bool done = false;
+        bool success = false;
+    } result;
+    auto onMapped = [](WGPUBufferMapAsyncStatus status, void *userdata) {
+        auto *result = static_cast<MapResult *>(userdata);
+        result->success = status == WGPUBufferMapAsyncStatus_Success;
+        result->done = true;
+    };
+    wgpuBufferMapAsync(buffer, mode, 0, size, onMapped, &result);
+    while (!result.done) {
+        wgpuDeviceTick(device);
+        if (!result.done) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    return result.success;
+}
+
 WGPUBindGroupLayoutEntry createDefaultBindingLayout ()
 {
     WGPUBindGroupLayoutEntry bindingLayout;
@@ -161,4 +196,97 @@ WGPUBindGroupLayoutEntry createDefaultBindingLayout ()
 
     return bindingLayout;
 }
+
+WGPUBindGroupEntry bufferBindGroupEntry(uint32_t binding, WGPUBuffer buffer, uint64_t size)
+{
+    WGPUBindGroupEntry entry{};
+    entry.nextInChain = nullptr;
+    entry.binding = binding;
+    entry.buffer = buffer;
+    entry.offset = 0;
+    entry.size = size;
+    return entry;
+}
+
+WGPUBindGroupEntry textureBindGroupEntry(uint32_t binding, WGPUTextureView view)
+{
+    WGPUBindGroupEntry entry{};
+    entry.nextInChain = nullptr;
+    entry.binding = binding;
+    entry.textureView = view;
+    return entry;
+}
+
+WGPUBindGroupEntry samplerBindGroupEntry(uint32_t binding, WGPUSampler sampler)
+{
+    WGPUBindGroupEntry entry{};
+    entry.nextInChain = nullptr;
+    entry.binding = binding;
+    entry.sampler = sampler;
+    return entry;
+}
+
+WGPUBindGroup createBindGroup(WGPUDevice device, WGPUBindGroupLayout layout,
+                              std::span<const WGPUBindGroupEntry> entries)
+{
+    WGPUBindGroupDescriptor bindGroupDesc{};
+    bindGroupDesc.nextInChain = nullptr;
+    bindGroupDesc.layout = layout;
+    bindGroupDesc.entryCount = entries.size();
+    bindGroupDesc.entries = entries.data();
+    WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(device, &bindGroupDesc);
+    wgpuBindGroupLayoutRelease(layout);
+    return bindGroup;
+}
+
+WGPUComputePipeline createComputePipeline(WGPUDevice device, WGPUShaderModule module,
+                                          const char *entryPoint)
+{
+    WGPUComputePipelineDescriptor pipelineDesc{};
+    pipelineDesc.nextInChain = nullptr;
+    pipelineDesc.label = entryPoint;
+    // Automatic layout: each entry point only gets the bindings it uses
+    pipelineDesc.layout = nullptr;
+    pipelineDesc.compute.module = module;
+    pipelineDesc.compute.entryPoint = entryPoint;
+    pipelineDesc.compute.constantCount = 0;
+    pipelineDesc.compute.constants = nullptr;
+    return wgpuDeviceCreateComputePipeline(device, &pipelineDesc);
+}
+
+WGPURenderPipeline createFullscreenPipeline(WGPUDevice device, WGPUShaderModule module,
+                                            const char *fragmentEntryPoint,
+                                            WGPUTextureFormat targetFormat)
+{
+    WGPUColorTargetState colorTarget{};
+    colorTarget.nextInChain = nullptr;
+    colorTarget.format = targetFormat;
+    colorTarget.blend = nullptr;
+    colorTarget.writeMask = WGPUColorWriteMask_All;
+
+    WGPUFragmentState fragmentState{};
+    fragmentState.nextInChain = nullptr;
+    fragmentState.module = module;
+    fragmentState.entryPoint = fragmentEntryPoint;
+    fragmentState.targetCount = 1;
+    fragmentState.targets = &colorTarget;
+
+    WGPURenderPipelineDescriptor pipelineDesc{};
+    pipelineDesc.nextInChain = nullptr;
+    pipelineDesc.label = fragmentEntryPoint;
+    pipelineDesc.layout = nullptr;
+    pipelineDesc.vertex.module = module;
+    pipelineDesc.vertex.entryPoint = "vs_fullscreen";
+    pipelineDesc.vertex.bufferCount = 0;
+    pipelineDesc.primitive.topology = WGPUPrimitiveTopology_TriangleList;
+    pipelineDesc.primitive.stripIndexFormat = WGPUIndexFormat_Undefined;
+    pipelineDesc.primitive.frontFace = WGPUFrontFace_CCW;
+    pipelineDesc.primitive.cullMode = WGPUCullMode_None;
+    pipelineDesc.fragment = &fragmentState;
+    pipelineDesc.depthStencil = nullptr;
+    pipelineDesc.multisample.count = 1;
+    pipelineDesc.multisample.mask = ~0u;
+    pipelineDesc.multisample.alphaToCoverageEnabled = false;
+    return wgpuDeviceCreateRenderPipeline(device, &pipelineDesc);
+}
 } // namespace Utils
@@ -1,7 +1,8 @@
 #pragma once
 
 #include <webgpu/webgpu.h>
-#include <filesystem>
+#include <span>
+#include <string_view>
 
 namespace Utils {
 WGPUAdapter requestAdapter(WGPUInstance instance,
@@ -10,8 +11,37 @@ WGPUAdapter requestAdapter(WGPUInstance instance,
 WGPUDevice requestDevice(WGPUAdapter adapter,
                          const WGPUDeviceDescriptor *descriptor);
 
-WGPUShaderModule loadShaderModule(const std::filesystem::path& filePath,
-                                  WGPUDevice device);
+// Compiles a WGSL source from Resources, e.g. "shaders/shader.wgsl". The
+// library sources are appended to it, so they can use its declarations and
+// the other way round.
+WGPUShaderModule loadShaderModule(std::string_view resourcePath,
+                                  WGPUDevice device,
+                                  std::span<const std::string_view> libraryPaths = {});
+
+// Maps the start of the buffer and ticks the device until that has finished.
+// Returns whether the mapping succeeded.
+bool mapBufferAndWait(WGPUDevice device, WGPUBuffer buffer, WGPUMapModeFlags mode, uint64_t size);
 
 WGPUBindGroupLayoutEntry createDefaultBindingLayout();
+
+WGPUBindGroupEntry bufferBindGroupEntry(uint32_t binding, WGPUBuffer buffer, uint64_t size);
+
+WGPUBindGroupEntry textureBindGroupEntry(uint32_t binding, WGPUTextureView view);
+
+WGPUBindGroupEntry samplerBindGroupEntry(uint32_t binding, WGPUSampler sampler);
+
+// Creates a bind group and releases the layout, which is meant to come from
+// wgpu*PipelineGetBindGroupLayout() of a pipeline with an automatic layout
+WGPUBindGroup createBindGroup(WGPUDevice device, WGPUBindGroupLayout layout,
+                              std::span<const WGPUBindGroupEntry> entries);
+
+// Compute pipeline with an automatic layout
+WGPUComputePipeline createComputePipeline(WGPUDevice device, WGPUShaderModule module,
+                                          const char *entryPoint);
+
+// Render pipeline drawing one triangle over the whole target with the
+// module's vs_fullscreen entry point, without vertex buffers or blending
+WGPURenderPipeline createFullscreenPipeline(WGPUDevice device, WGPUShaderModule module,
+                                            const char *fragmentEntryPoint,
+                                            WGPUTextureFormat targetFormat);
 } // namespace Utils